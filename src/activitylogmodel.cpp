@@ -0,0 +1,101 @@
+#include "activitylogmodel.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <algorithm>
+
+ActivityLogModel::ActivityLogModel(int capacity, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_entries(std::max(capacity, 10))
+{
+}
+
+int ActivityLogModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant ActivityLogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+    const Entry& entry = entryAt(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return entry.line;
+    case Qt::ForegroundRole:
+        if (entry.level == Level::Error) {
+            return QColor(Qt::red);
+        }
+        if (entry.level == Level::Warning) {
+            return QColor(Qt::darkYellow);
+        }
+        return QVariant();
+    case LevelRole:
+        return static_cast<int>(entry.level);
+    default:
+        return QVariant();
+    }
+}
+
+void ActivityLogModel::append(Level level, const QString& message)
+{
+    const int capacity = this->capacity();
+    if (m_count == capacity) {
+        const int evict = capacity / 10;
+        beginRemoveRows(QModelIndex(), 0, evict - 1);
+        for (int i = 0; i < evict; ++i) {
+            m_entries[(m_first + i) % capacity] = Entry(); // free the text now
+        }
+        m_first = (m_first + evict) % capacity;
+        m_count -= evict;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count);
+    Entry& entry = m_entries[(m_first + m_count) % capacity];
+    entry.line = QStringLiteral("[%1] %2").arg(QDateTime::currentDateTime().toString("hh:mm:ss"), message);
+    entry.level = level;
+    ++m_count;
+    endInsertRows();
+}
+
+const ActivityLogModel::Entry& ActivityLogModel::entryAt(int row) const
+{
+    return m_entries[(m_first + row) % m_entries.size()];
+}
+
+ActivityLogFilter::ActivityLogFilter(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+void ActivityLogFilter::setMinimumLevel(ActivityLogModel::Level level)
+{
+    m_minimumLevel = level;
+    invalidateFilter();
+}
+
+void ActivityLogFilter::setText(const QString& text)
+{
+    m_text = text;
+    invalidateFilter();
+}
+
+bool ActivityLogFilter::isActive() const
+{
+    return m_minimumLevel != ActivityLogModel::Level::Info || !m_text.isEmpty();
+}
+
+bool ActivityLogFilter::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    const auto level = static_cast<ActivityLogModel::Level>(index.data(ActivityLogModel::LevelRole).toInt());
+    if (level < m_minimumLevel) {
+        return false;
+    }
+    return m_text.isEmpty() || index.data(Qt::DisplayRole).toString().contains(m_text, Qt::CaseInsensitive);
+}
@@ -0,0 +1,75 @@
+#ifndef ACTIVITYLOGMODEL_H
+#define ACTIVITYLOGMODEL_H
+
+#include "gitmodels.h"
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <vector>
+
+/**
+ * The activity log: the most recent capacity() messages, oldest first, in a
+ * ring buffer. Appending is O(1) however long the application runs; once the
+ * buffer is full the oldest tenth is dropped in one go, so the view sees one
+ * row removal per few hundred messages rather than one per message.
+ *
+ * Meant for a QListView with uniform item sizes, which only lays out and
+ * paints the rows on screen.
+ */
+class ActivityLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    using Level = LogLevel;
+    enum Role { LevelRole = Qt::UserRole + 1 };
+
+    explicit ActivityLogModel(int capacity, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    int capacity() const { return static_cast<int>(m_entries.size()); }
+
+    /** Timestamp and store a message at the level its emitter gave it. */
+    void append(Level level, const QString& message);
+
+private:
+    struct Entry {
+        QString line; // "[hh:mm:ss] message"
+        Level level = Level::Info;
+    };
+
+    const Entry& entryAt(int row) const;
+
+    std::vector<Entry> m_entries; // the ring; m_count used from m_first on
+    int m_first = 0;
+    int m_count = 0;
+};
+
+/**
+ * Narrows the activity log to a minimum level and to lines containing a
+ * text, typically a repository name. Only attach it while a filter is set:
+ * the proxy's bookkeeping makes evicting old rows cost time per row kept.
+ */
+class ActivityLogFilter : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit ActivityLogFilter(QObject* parent = nullptr);
+
+    void setMinimumLevel(ActivityLogModel::Level level);
+    void setText(const QString& text);
+    bool isActive() const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    ActivityLogModel::Level m_minimumLevel = ActivityLogModel::Level::Info;
+    QString m_text;
+};
+
+#endif // ACTIVITYLOGMODEL_H
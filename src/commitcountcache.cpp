@@ -0,0 +1,132 @@
+#include "commitcountcache.h"
+#include "repositorystore.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int kMaxEntries = 50000;  // a few MB at most, far more pairs than tracked remotes
+constexpr int kFormatVersion = 1;
+} // namespace
+
+QString CommitCountCache::keyFor(const QString& localSha, const QString& remoteSha)
+{
+    return localSha + QLatin1Char(':') + remoteSha;
+}
+
+bool CommitCountCache::lookup(const QString& localSha, const QString& remoteSha, int& ahead, int& behind)
+{
+    if (localSha.isEmpty() || remoteSha.isEmpty()) {
+        return false;
+    }
+    QMutexLocker lock(&m_mutex);
+    const auto it = m_entries.find(keyFor(localSha, remoteSha));
+    if (it == m_entries.end()) {
+        return false;
+    }
+    it->lastUsed = ++m_clock;
+    ahead = it->ahead;
+    behind = it->behind;
+    return true;
+}
+
+void CommitCountCache::insert(const QString& localSha, const QString& remoteSha, int ahead, int behind)
+{
+    if (localSha.isEmpty() || remoteSha.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    Entry& entry = m_entries[keyFor(localSha, remoteSha)];
+    entry.ahead = ahead;
+    entry.behind = behind;
+    entry.lastUsed = ++m_clock;
+    m_dirty = true;
+    if (m_entries.size() > kMaxEntries) {
+        evictLocked();
+    }
+}
+
+void CommitCountCache::evictLocked()
+{
+    // Drop the least recently used quarter in one go so eviction cost is
+    // amortized over many inserts. Exactly a quarter goes even when many
+    // entries share an age, otherwise ties could leave every insert paying
+    // for a scan that frees nothing.
+    std::vector<std::pair<quint64, QString>> ages;
+    ages.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        ages.emplace_back(it->lastUsed, it.key());
+    }
+    const auto cut = ages.begin() + static_cast<std::ptrdiff_t>(ages.size() / 4);
+    std::nth_element(ages.begin(), cut, ages.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (auto it = ages.begin(); it != cut; ++it) {
+        m_entries.remove(it->second);
+    }
+}
+
+bool CommitCountCache::isDirty() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_dirty;
+}
+
+void CommitCountCache::load(const QString& path)
+{
+    QFile file(path);
+    QHash<QString, Entry> loaded;
+    quint64 clock = 0;
+    if (file.open(QIODevice::ReadOnly)) {
+        const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        if (root.value("version").toInt() == kFormatVersion) {
+            // Each entry is "<local>:<remote>": [ahead, behind].
+            const QJsonObject pairs = root.value("pairs").toObject();
+            for (auto it = pairs.constBegin(); it != pairs.constEnd() && loaded.size() < kMaxEntries; ++it) {
+                const QJsonArray counts = it.value().toArray();
+                if (counts.size() != 2) {
+                    continue;
+                }
+                Entry entry;
+                entry.ahead = counts.at(0).toInt();
+                entry.behind = counts.at(1).toInt();
+                // Recency isn't saved; distinct ages keep eviction well-defined.
+                entry.lastUsed = ++clock;
+                loaded.insert(it.key(), entry);
+            }
+        }
+    }
+
+    QMutexLocker lock(&m_mutex);
+    m_entries = loaded;
+    m_clock = clock;
+    m_dirty = false;
+}
+
+bool CommitCountCache::save(const QString& path, QString* errorMessage)
+{
+    QJsonObject pairs;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            pairs.insert(it.key(), QJsonArray{it->ahead, it->behind});
+        }
+        m_dirty = false;
+    }
+
+    QJsonObject root;
+    root["version"] = kFormatVersion;
+    root["pairs"] = pairs;
+    if (!RepositoryStore::writeFileAtomically(path, QJsonDocument(root).toJson(QJsonDocument::Compact), errorMessage)) {
+        QMutexLocker lock(&m_mutex);
+        m_dirty = true;
+        return false;
+    }
+    return true;
+}
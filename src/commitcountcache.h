@@ -0,0 +1,50 @@
+#ifndef COMMITCOUNTCACHE_H
+#define COMMITCOUNTCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Memoized ahead/behind results keyed on the pair of commits compared.
+ *
+ * The count between two commits never changes, so once a (local SHA, remote
+ * SHA) pair has been walked the answer can be reused until either tip moves:
+ * a fetch that brought nothing new, or a harmless HEAD touch, costs a ref read
+ * instead of a `rev-list` walk. Thread-safe; the counting runs on pool threads.
+ *
+ * The cache can be persisted to a small JSON file so counts are available the
+ * moment the app starts. Its size is bounded; the least recently used pairs
+ * are dropped first.
+ */
+class CommitCountCache
+{
+public:
+    bool lookup(const QString& localSha, const QString& remoteSha, int& ahead, int& behind);
+    void insert(const QString& localSha, const QString& remoteSha, int ahead, int behind);
+
+    /** True if entries were added since the last load()/save(). */
+    bool isDirty() const;
+
+    /** Replace the contents with the cache file at path. Missing/corrupt files leave it empty. */
+    void load(const QString& path);
+    /** Atomically write the cache to path. Returns false and sets *errorMessage on failure. */
+    bool save(const QString& path, QString* errorMessage = nullptr);
+
+private:
+    struct Entry {
+        int ahead = 0;
+        int behind = 0;
+        quint64 lastUsed = 0; // value of m_clock when last read or written
+    };
+
+    static QString keyFor(const QString& localSha, const QString& remoteSha);
+    void evictLocked();
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    quint64 m_clock = 0;
+    bool m_dirty = false;
+};
+
+#endif // COMMITCOUNTCACHE_H
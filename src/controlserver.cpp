@@ -0,0 +1,295 @@
+#include "controlserver.h"
+#include "fetchcore.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QTimer>
+#include <utility>
+
+namespace {
+constexpr int kEventFlushIntervalMs = 100;
+// A request is a short JSON line; anything longer without a newline is not a
+// well-behaved client.
+constexpr qint64 kMaxRequestBytes = 64 * 1024;
+// Events a subscriber hasn't read yet pile up in our write buffer; past this
+// it is evidently not reading and is disconnected.
+constexpr qint64 kMaxSubscriberBacklogBytes = 1024 * 1024;
+
+bool isInside(const QString& path, const QString& root)
+{
+    return path == root || (path.startsWith(root) && path.at(root.size()) == QLatin1Char('/'));
+}
+} // namespace
+
+ControlServer::ControlServer(FetchCore *core, QObject *parent)
+    : QObject(parent)
+    , m_core(core)
+    , m_server(new QLocalServer(this))
+    , m_eventTimer(new QTimer(this))
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+
+    m_eventTimer->setSingleShot(true);
+    m_eventTimer->setInterval(kEventFlushIntervalMs);
+    connect(m_eventTimer, &QTimer::timeout, this, &ControlServer::flushEvents);
+
+    connect(m_core, &FetchCore::repositoryStatusChanged, this, &ControlServer::onRepositoryChanged);
+    connect(m_core, &FetchCore::remoteChanged, this, &ControlServer::onRepositoryChanged);
+}
+
+ControlServer::~ControlServer()
+{
+    m_server->close();
+}
+
+QString ControlServer::socketPath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        dir = QDir::tempPath();
+    }
+    return dir + QStringLiteral("/fetchdeeznutz.sock");
+}
+
+bool ControlServer::listen(QString *error)
+{
+    const QString path = socketPath();
+    if (m_server->listen(path)) {
+        return true;
+    }
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // Either another instance is serving it or a crashed one left the
+        // file behind; only the latter may be replaced.
+        QLocalSocket probe;
+        probe.connectToServer(path);
+        if (probe.waitForConnected(200)) {
+            if (error) {
+                *error = QString("%1 is in use by another instance").arg(path);
+            }
+            return false;
+        }
+        QLocalServer::removeServer(path);
+        if (m_server->listen(path)) {
+            return true;
+        }
+    }
+    if (error) {
+        *error = m_server->errorString();
+    }
+    return false;
+}
+
+QJsonObject ControlServer::repositoryJson(const GitRepository& repo)
+{
+    QJsonArray remotes;
+    int ahead = 0;
+    int behind = 0;
+    for (const GitRemote& remote : repo.remotes) {
+        QJsonObject obj;
+        obj["name"] = remote.name;
+        obj["url"] = remote.url;
+        obj["status"] = fetchStatusText(remote.status);
+        obj["lastFetch"] = remote.lastFetch;
+        obj["ahead"] = remote.commitsAhead;
+        obj["behind"] = remote.commitsBehind;
+        if (!remote.progressText.isEmpty()) {
+            obj["progress"] = remote.progressText;
+        }
+        remotes.append(obj);
+        ahead += remote.commitsAhead;
+        behind += remote.commitsBehind;
+    }
+
+    QJsonObject obj;
+    // Unique within this run of the application, unlike the name.
+    obj["id"] = double(repo.id);
+    obj["name"] = repo.name;
+    obj["path"] = repo.localPath;
+    obj["branch"] = repo.branch;
+    obj["enabled"] = repo.enabled;
+    obj["status"] = fetchStatusText(repo.status);
+    obj["lastFetch"] = repo.lastFetch;
+    // Summed over remotes, like the repository row in the window.
+    obj["ahead"] = ahead;
+    obj["behind"] = behind;
+    obj["remotes"] = remotes;
+    return obj;
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *client = m_server->nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, &ControlServer::onReadyRead);
+        connect(client, &QLocalSocket::disconnected, this, &ControlServer::onDisconnected);
+    }
+}
+
+void ControlServer::onReadyRead()
+{
+    auto *client = qobject_cast<QLocalSocket*>(sender());
+    if (!client) {
+        return;
+    }
+
+    while (client->canReadLine()) {
+        const QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (!doc.isObject()) {
+            send(client, QJsonObject{{"ok", false}, {"error", QString("malformed request: %1").arg(parseError.errorString())}});
+            continue;
+        }
+        QJsonObject response = handleRequest(client, doc.object());
+        const QJsonValue id = doc.object().value("id");
+        if (!id.isUndefined()) {
+            response["id"] = id;
+        }
+        send(client, response);
+    }
+
+    if (client->bytesAvailable() > kMaxRequestBytes) {
+        client->abort();
+    }
+}
+
+void ControlServer::onDisconnected()
+{
+    auto *client = qobject_cast<QLocalSocket*>(sender());
+    if (!client) {
+        return;
+    }
+    m_subscribers.removeAll(client);
+    client->deleteLater();
+}
+
+QJsonObject ControlServer::handleRequest(QLocalSocket *client, const QJsonObject& request)
+{
+    const QString cmd = request.value("cmd").toString();
+
+    if (cmd == QLatin1String("list")) {
+        QJsonArray repositories;
+        for (const GitRepository& repo : m_core->repositories()) {
+            repositories.append(repositoryJson(repo));
+        }
+        return QJsonObject{{"ok", true}, {"repositories", repositories}};
+    }
+
+    if (cmd == QLatin1String("status")) {
+        const GitRepository *repo = nullptr;
+        if (request.contains("path")) {
+            repo = repositoryForPath(request.value("path").toString());
+        } else {
+            repo = requestedRepository(request);
+        }
+        if (!repo) {
+            return QJsonObject{{"ok", false}, {"error", "unknown repository"}};
+        }
+        return QJsonObject{{"ok", true}, {"repository", repositoryJson(*repo)}};
+    }
+
+    if (cmd == QLatin1String("fetch")) {
+        if (!request.contains("repo") && !request.contains("repoId")) {
+            int queued = 0;
+            for (const GitRepository& repo : m_core->repositories()) {
+                queued += repo.enabled ? 1 : 0;
+            }
+            m_core->fetchAll();
+            return QJsonObject{{"ok", true}, {"queued", queued}};
+        }
+        GitRepository *repo = requestedRepository(request);
+        if (!repo) {
+            return QJsonObject{{"ok", false}, {"error", "unknown repository"}};
+        }
+        // Same priority as the window's "Fetch Selected": someone is waiting.
+        m_core->enqueueFetch(*repo, FetchScheduler::Priority::Manual);
+        return QJsonObject{{"ok", true}, {"queued", 1}};
+    }
+
+    if (cmd == QLatin1String("subscribe")) {
+        if (!m_subscribers.contains(client)) {
+            m_subscribers.append(client);
+        }
+        return QJsonObject{{"ok", true}};
+    }
+
+    return QJsonObject{{"ok", false}, {"error", QString("unknown command \"%1\"").arg(cmd)}};
+}
+
+GitRepository* ControlServer::requestedRepository(const QJsonObject& request) const
+{
+    if (request.contains("repoId")) {
+        return m_core->repository(RepositoryId(request.value("repoId").toDouble()));
+    }
+    return m_core->repositoryByName(request.value("repo").toString());
+}
+
+const GitRepository* ControlServer::repositoryForPath(const QString& path) const
+{
+    const QString target = QDir::cleanPath(path);
+    const GitRepository *best = nullptr;
+    qsizetype bestLength = -1;
+    for (const GitRepository& repo : m_core->repositories()) {
+        QStringList roots = repo.worktrees;
+        roots.prepend(repo.localPath);
+        for (const QString& root : roots) {
+            const QString cleanRoot = QDir::cleanPath(root);
+            if (cleanRoot.size() > bestLength && isInside(target, cleanRoot)) {
+                best = &repo;
+                bestLength = cleanRoot.size();
+            }
+        }
+    }
+    return best;
+}
+
+void ControlServer::onRepositoryChanged(RepositoryId repoId)
+{
+    if (m_subscribers.isEmpty()) {
+        return;
+    }
+    m_changedRepositories.insert(repoId);
+    if (!m_eventTimer->isActive()) {
+        m_eventTimer->start();
+    }
+}
+
+void ControlServer::flushEvents()
+{
+    const QSet<RepositoryId> changed = std::exchange(m_changedRepositories, {});
+    for (RepositoryId repoId : changed) {
+        const GitRepository *repo = m_core->repository(repoId);
+        if (!repo) {
+            continue; // removed since
+        }
+        const QJsonObject event{{"event", "repository"}, {"repository", repositoryJson(*repo)}};
+        for (QLocalSocket *client : std::as_const(m_subscribers)) {
+            send(client, event);
+        }
+    }
+
+    // Aborting emits disconnected(), which edits m_subscribers; collect first.
+    QList<QLocalSocket*> stalled;
+    for (QLocalSocket *client : std::as_const(m_subscribers)) {
+        if (client->bytesToWrite() > kMaxSubscriberBacklogBytes) {
+            stalled.append(client);
+        }
+    }
+    for (QLocalSocket *client : std::as_const(stalled)) {
+        m_subscribers.removeAll(client);
+        client->abort();
+    }
+}
+
+void ControlServer::send(QLocalSocket *client, const QJsonObject& message)
+{
+    client->write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    client->write("\n", 1);
+}
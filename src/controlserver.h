@@ -0,0 +1,86 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include "gitmodels.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class FetchCore;
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+/**
+ * Local control socket so other tools (shell prompts, editors, scripts) can
+ * read repository state and trigger fetches without running git themselves.
+ *
+ * Listens on a Unix-domain socket (socketPath(), a named pipe on Windows)
+ * that only the current user can open. The protocol is one JSON object per
+ * line in each direction. A request may carry an "id", which is echoed in its
+ * response.
+ *
+ *   {"cmd":"list"}                     -> {"ok":true,"repositories":[...]}
+ *   {"cmd":"status","repo":"<name>"}   -> {"ok":true,"repository":{...}}
+ *   {"cmd":"status","repoId":<id>}     -> by a repository's "id" from an earlier answer
+ *   {"cmd":"status","path":"<dir>"}    -> the repository containing dir
+ *   {"cmd":"fetch","repo":"<name>"}    -> {"ok":true,"queued":1} (or "repoId")
+ *   {"cmd":"fetch"}                    -> every enabled repository
+ *   {"cmd":"subscribe"}                -> {"ok":true}, then
+ *                                         {"event":"repository","repository":{...}}
+ *                                         whenever a repository's state changes;
+ *                                         a subscriber that stops reading is
+ *                                         disconnected once its backlog passes 1 MiB
+ *
+ * Failures answer {"ok":false,"error":"..."}. Every answer comes from the
+ * core's in-memory repository list; nothing here spawns git or reads files.
+ */
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ControlServer(FetchCore *core, QObject *parent = nullptr);
+    ~ControlServer();
+
+    /** Where the socket lives: $XDG_RUNTIME_DIR/fetchdeeznutz.sock on Linux. */
+    static QString socketPath();
+
+    /**
+     * Start listening. Fails, with a reason in error, if another instance is
+     * already serving the socket; a stale socket file is replaced.
+     */
+    bool listen(QString *error = nullptr);
+
+    /** A repository's state as sent to clients. */
+    static QJsonObject repositoryJson(const GitRepository& repo);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onRepositoryChanged(RepositoryId repoId);
+    // Sends one event per repository that changed since the last flush.
+    void flushEvents();
+
+private:
+    QJsonObject handleRequest(QLocalSocket *client, const QJsonObject& request);
+    // The repository a request names by "repoId" or "repo", or nullptr.
+    GitRepository* requestedRepository(const QJsonObject& request) const;
+    // The tracked repository containing path (or one of its worktrees); the
+    // deepest match wins.
+    const GitRepository* repositoryForPath(const QString& path) const;
+    static void send(QLocalSocket *client, const QJsonObject& message);
+
+    FetchCore *m_core;
+    QLocalServer *m_server;
+    QTimer *m_eventTimer;               // coalesces bursts of progress updates
+    QList<QLocalSocket*> m_subscribers;
+    QSet<RepositoryId> m_changedRepositories; // since the last flush
+};
+
+#endif // CONTROLSERVER_H
@@ -0,0 +1,8 @@
+#include "fetchdaemon.h"
+
+// fetchdeeznutz-daemon: links fetchdeeznutz_core only, so neither QtGui nor
+// QtWidgets (nor the display, GL and font libraries they pull in) are loaded.
+int main(int argc, char *argv[])
+{
+    return runDaemon(argc, argv);
+}
@@ -0,0 +1,701 @@
+#include "fetchcore.h"
+#include "controlserver.h"
+#include "fetchjournal.h"
+#include "fetchplanner.h"
+#include "gitfetchworker.h"
+#include "repowatcher.h"
+#include "statussnapshotwriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QMetaType>
+#include <QSettings>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent>
+
+FetchCore::FetchCore(QObject *parent)
+    : QObject(parent)
+    , fetchThread(new QThread(this))
+    , fetchWorker(new GitFetchWorker())
+    , journalThread(new QThread(this))
+    , fetchJournal(new FetchJournal(FetchJournal::defaultFilePath()))
+    , fetchScheduler(new FetchScheduler(this))
+    , fetchPlanner(new FetchPlanner(this))
+    , repoWatcher(new RepoWatcher(this))
+    , countPool(new QThreadPool(this))
+    , countCacheSaveTimer(new QTimer(this))
+    , snapshotSaveTimer(new QTimer(this))
+    , runtimeStateSaveTimer(new QTimer(this))
+    , controlServer(new ControlServer(this, this))
+{
+    // Register types with Qt's meta-object system (must be done before moving to thread)
+    qRegisterMetaType<GitRemote>("GitRemote");
+    qRegisterMetaType<GitRepository>("GitRepository");
+    qRegisterMetaType<FetchProgress>("FetchProgress");
+    qRegisterMetaType<RepositoryId>("RepositoryId");
+    qRegisterMetaType<QList<RemoteStatusUpdate>>("QList<RemoteStatusUpdate>");
+    qRegisterMetaType<RemoteFetchRecord>("RemoteFetchRecord");
+
+    // Verify registration (using QMetaType::fromType for Qt6 compatibility)
+    if (!QMetaType::fromType<GitRepository>().isValid()) {
+        qWarning() << "Failed to register GitRepository meta type";
+    }
+    if (!QMetaType::fromType<GitRemote>().isValid()) {
+        qWarning() << "Failed to register GitRemote meta type";
+    }
+
+    // Setup background thread and worker
+    fetchWorker->moveToThread(fetchThread);
+    connect(fetchThread, &QThread::finished, fetchWorker, &GitFetchWorker::deleteLater);
+    connect(fetchWorker, &GitFetchWorker::fetchStarted, this, &FetchCore::onFetchStarted);
+    connect(fetchWorker, &GitFetchWorker::fetchProgress, this, &FetchCore::onFetchProgress);
+    connect(fetchWorker, &GitFetchWorker::remoteStatusesChanged, this, &FetchCore::onRemoteStatusesChanged);
+    connect(fetchWorker, &GitFetchWorker::fetchFinished, this, &FetchCore::onFetchFinished);
+    connect(fetchWorker, &GitFetchWorker::fetchError, this, &FetchCore::onFetchError);
+    connect(fetchWorker, &GitFetchWorker::newTagsFound, this, &FetchCore::onNewTagsFound);
+    connect(fetchWorker, &GitFetchWorker::probeSkipsChanged, this, &FetchCore::probeSkipsChanged);
+
+    // The fetch journal gets its own thread so buffered disk writes never
+    // hold up either the worker or the GUI; the worker's records go straight
+    // there.
+    fetchJournal->moveToThread(journalThread);
+    connect(journalThread, &QThread::finished, fetchJournal, &FetchJournal::deleteLater);
+    connect(fetchWorker, &GitFetchWorker::remoteFetchRecorded, fetchJournal, &FetchJournal::recordFetch);
+    connect(fetchJournal, &FetchJournal::writeFailed, this, [this](const QString& error) {
+        emit logMessage(LogLevel::Error, QString("Failed to write fetch journal: %1").arg(error));
+    });
+
+    // All fetch requests go through the scheduler, which releases them to the
+    // worker within the per-host / global concurrency limits.
+    connect(fetchScheduler, &FetchScheduler::fetchDispatched, fetchWorker, &GitFetchWorker::fetchRepository);
+    connect(fetchWorker, &GitFetchWorker::fetchFinished, fetchScheduler, &FetchScheduler::onFetchFinished);
+    connect(fetchWorker, &GitFetchWorker::fetchError, fetchScheduler, &FetchScheduler::onFetchFinished);
+
+    // Each enabled repository comes due on its own (jittered) schedule.
+    connect(fetchPlanner, &FetchPlanner::due, this, &FetchCore::performScheduledFetch);
+
+    // Watch tracked repos for external git changes (commit/checkout/rebase) so
+    // their ahead/behind counts stay live without waiting for a fetch.
+    connect(repoWatcher, &RepoWatcher::repositoryChanged, this, &FetchCore::onExternalRepositoryChanged);
+
+    // Commit-count cache writes are debounced: a fetch wave produces a burst of
+    // new pairs, which are flushed to disk together once it settles.
+    countCacheSaveTimer->setSingleShot(true);
+    countCacheSaveTimer->setInterval(30000);
+    connect(countCacheSaveTimer, &QTimer::timeout, this, &FetchCore::saveCommitCountCache);
+
+    // The status snapshot follows every visible change, at most twice a
+    // second so a fetch wave's progress updates don't turn into disk writes.
+    snapshotSaveTimer->setSingleShot(true);
+    snapshotSaveTimer->setInterval(500);
+    connect(snapshotSaveTimer, &QTimer::timeout, this, &FetchCore::saveStatusSnapshot);
+    connect(this, &FetchCore::repositoryStatusChanged, this, &FetchCore::scheduleStatusSnapshot);
+    connect(this, &FetchCore::remoteChanged, this, &FetchCore::scheduleStatusSnapshot);
+
+    // Last-fetch times change with every fetch; a wave's worth is written
+    // together a few seconds after it starts rather than once per remote.
+    runtimeStateSaveTimer->setSingleShot(true);
+    runtimeStateSaveTimer->setInterval(5000);
+    connect(runtimeStateSaveTimer, &QTimer::timeout, this, &FetchCore::saveRuntimeState);
+
+    fetchThread->start();
+    journalThread->start(QThread::LowPriority);
+}
+
+FetchCore::~FetchCore()
+{
+    // Count calculations use m_countCache and post back to us: drop the ones
+    // not yet started and let the running ones finish first.
+    countPool->clear();
+    countPool->waitForDone();
+
+    saveRepositories();
+    saveCommitCountCache();
+    saveStatusSnapshot();
+    saveRuntimeState();
+
+    // Clean up background thread
+    fetchScheduler->clearPending();
+    // The worker's processes live on its thread; kill them there.
+    QMetaObject::invokeMethod(fetchWorker, "stopFetching", Qt::BlockingQueuedConnection);
+    fetchThread->quit();
+    fetchThread->wait();
+    // After the worker: stopFetching() recorded every fetch it cancelled, and
+    // those records are queued ahead of this flush.
+    QMetaObject::invokeMethod(fetchJournal, "flush", Qt::BlockingQueuedConnection);
+    journalThread->quit();
+    journalThread->wait();
+}
+
+void FetchCore::start()
+{
+    loadSettings(); // Load settings before loading repositories
+    loadRepositories();
+    syncRepositories();
+
+    // The planner picked up each repository's last successful fetch from
+    // the restored state; one whose last attempt failed waits an interval
+    // from that attempt too, instead of being retried on every launch.
+    for (const GitRepository& repo : m_repositories) {
+        const RuntimeState::Repository* state = m_runtimeState.find(repo.localPath);
+        if (state && state->lastAttemptMs > state->lastSuccessMs) {
+            fetchPlanner->markFetched(repo.id, state->lastAttemptMs);
+        }
+    }
+
+    // Start the schedule based on loaded settings. Only repositories that
+    // are overdue (or were never fetched) come due within the first few
+    // seconds, spread out rather than all at once; the rest keep their place
+    // in the schedule from the last session.
+    if (m_autoFetch) {
+        fetchPlanner->start();
+    }
+
+    QString error;
+    if (controlServer->listen(&error)) {
+        emit logMessage(LogLevel::Info, QString("Control socket listening at %1").arg(ControlServer::socketPath()));
+    } else {
+        emit logMessage(LogLevel::Warning, QString("Control socket disabled: %1").arg(error));
+    }
+}
+
+GitRepository* FetchCore::repository(RepositoryId repoId)
+{
+    int index = m_indexById.value(repoId, -1);
+    if (index < 0 || index >= m_repositories.size() || m_repositories[index].id != repoId) {
+        // The list changed since the last syncRepositories().
+        reindex();
+        index = m_indexById.value(repoId, -1);
+    }
+    return index >= 0 ? &m_repositories[index] : nullptr;
+}
+
+GitRepository* FetchCore::repositoryByName(const QString& repoName)
+{
+    for (GitRepository& repo : m_repositories) {
+        if (repo.name == repoName) {
+            return &repo;
+        }
+    }
+    return nullptr;
+}
+
+bool FetchCore::removeRepository(RepositoryId repoId)
+{
+    if (!repository(repoId)) {
+        return false;
+    }
+    // repository() just confirmed (or rebuilt) the index entry.
+    m_repositories.removeAt(m_indexById.take(repoId));
+    return true;
+}
+
+void FetchCore::reindex()
+{
+    m_indexById.clear();
+    m_indexById.reserve(m_repositories.size());
+    for (int i = 0; i < m_repositories.size(); ++i) {
+        GitRepository& repo = m_repositories[i];
+        if (repo.id == 0) {
+            repo.id = m_nextId++;
+        }
+        m_indexById.insert(repo.id, i);
+    }
+}
+
+GitRemote* FetchCore::remote(RepositoryId repoId, const QString& remoteName)
+{
+    GitRepository* repo = repository(repoId);
+    if (!repo) {
+        return nullptr;
+    }
+    for (GitRemote& remote : repo->remotes) {
+        if (remote.name == remoteName) {
+            return &remote;
+        }
+    }
+    return nullptr;
+}
+
+void FetchCore::syncRepositories()
+{
+    reindex();
+    // Keep the filesystem watcher's targets and the fetch schedule in sync
+    // with the tracked set.
+    repoWatcher->setRepositories(m_repositories);
+    fetchPlanner->setRepositories(m_repositories);
+    scheduleStatusSnapshot();
+    // Forget the history of repositories that are no longer tracked.
+    m_runtimeState.retain(m_repositories);
+    scheduleRuntimeStateSave();
+}
+
+void FetchCore::loadSettings()
+{
+    QSettings settings;
+
+    // Load global interval (default: 60 minutes)
+    m_minimumInterval = settings.value("globalInterval", 60).toInt();
+    fetchPlanner->setMinimumInterval(m_minimumInterval);
+
+    // Load schedule jitter (default: +/-10% of each repository's interval)
+    fetchPlanner->setJitterPercent(settings.value("scheduleJitterPercent", 10).toInt());
+
+    // Load fetch timeout (default: 300 seconds = 5 minutes)
+    m_fetchTimeout = settings.value("fetchTimeout", 300).toInt();
+    QMetaObject::invokeMethod(fetchWorker, "setTimeout", Qt::QueuedConnection, Q_ARG(int, m_fetchTimeout));
+
+    // Load connection timeout (default: 5 seconds)
+    m_connectionTimeout = settings.value("connectionTimeout", 5).toInt();
+    QMetaObject::invokeMethod(fetchWorker, "setConnectionTimeout", Qt::QueuedConnection, Q_ARG(int, m_connectionTimeout));
+
+    // Load overall concurrency limit (default: twice the core count, at least 4)
+    fetchScheduler->setGlobalLimit(settings.value("maxConcurrentFetches", fetchScheduler->globalLimit()).toInt());
+    QMetaObject::invokeMethod(fetchWorker, "setMaxConcurrentFetches", Qt::QueuedConnection,
+                              Q_ARG(int, fetchScheduler->globalLimit()));
+
+    // Load per-host concurrency limit (default: 4 repositories per server)
+    fetchScheduler->setHostLimit(settings.value("perHostFetchLimit", 4).toInt());
+
+    // Load auto-fetch enabled state (default: true)
+    m_autoFetch = settings.value("autoFetchEnabled", true).toBool();
+
+    // Load commit-count persistence preference (default: true)
+    m_persistCounts = settings.value("persistCommitCounts", true).toBool();
+
+    // Load probe-before-fetch mode (default: false -> always fetch)
+    m_probeBeforeFetch = settings.value("probeBeforeFetch", false).toBool();
+    QMetaObject::invokeMethod(fetchWorker, "setProbeBeforeFetch", Qt::QueuedConnection,
+                              Q_ARG(bool, m_probeBeforeFetch));
+}
+
+void FetchCore::setMinimumInterval(int minutes)
+{
+    m_minimumInterval = minutes;
+    QSettings().setValue("globalInterval", minutes);
+    fetchPlanner->setMinimumInterval(minutes);
+    fetchPlanner->setRepositories(m_repositories);
+    if (m_autoFetch) {
+        emit logMessage(LogLevel::Info, QString("Auto-fetch interval changed to %1 minutes").arg(minutes));
+    }
+}
+
+int FetchCore::jitterPercent() const
+{
+    return fetchPlanner->jitterPercent();
+}
+
+void FetchCore::setJitterPercent(int percent)
+{
+    QSettings().setValue("scheduleJitterPercent", percent);
+    fetchPlanner->setJitterPercent(percent); // applies from each repo's next reschedule
+}
+
+void FetchCore::setFetchTimeout(int seconds)
+{
+    m_fetchTimeout = seconds;
+    QSettings().setValue("fetchTimeout", seconds);
+    QMetaObject::invokeMethod(fetchWorker, "setTimeout", Qt::QueuedConnection, Q_ARG(int, seconds));
+    emit logMessage(LogLevel::Info, QString("Fetch timeout changed to %1 seconds").arg(seconds));
+}
+
+void FetchCore::setConnectionTimeout(int seconds)
+{
+    m_connectionTimeout = seconds;
+    QSettings().setValue("connectionTimeout", seconds);
+    QMetaObject::invokeMethod(fetchWorker, "setConnectionTimeout", Qt::QueuedConnection, Q_ARG(int, seconds));
+    emit logMessage(LogLevel::Info, QString("Connection timeout changed to %1 seconds").arg(seconds));
+}
+
+int FetchCore::maxConcurrentFetches() const
+{
+    return fetchScheduler->globalLimit();
+}
+
+void FetchCore::setMaxConcurrentFetches(int count)
+{
+    QSettings().setValue("maxConcurrentFetches", count);
+    fetchScheduler->setGlobalLimit(count);
+    QMetaObject::invokeMethod(fetchWorker, "setMaxConcurrentFetches", Qt::QueuedConnection, Q_ARG(int, count));
+    emit logMessage(LogLevel::Info, QString("Parallel fetch limit changed to %1").arg(count));
+}
+
+int FetchCore::hostLimit() const
+{
+    return fetchScheduler->hostLimit();
+}
+
+void FetchCore::setHostLimit(int limit)
+{
+    QSettings().setValue("perHostFetchLimit", limit);
+    fetchScheduler->setHostLimit(limit);
+    emit logMessage(LogLevel::Info, QString("Per-host fetch limit changed to %1").arg(limit));
+}
+
+void FetchCore::setAutoFetch(bool enabled)
+{
+    m_autoFetch = enabled;
+    QSettings().setValue("autoFetchEnabled", enabled);
+    if (enabled) {
+        fetchPlanner->start();
+        emit logMessage(LogLevel::Info, "Auto-fetch enabled");
+    } else {
+        fetchPlanner->stop();
+        emit logMessage(LogLevel::Info, "Auto-fetch disabled");
+    }
+}
+
+void FetchCore::setPersistCommitCounts(bool enabled)
+{
+    m_persistCounts = enabled;
+    QSettings().setValue("persistCommitCounts", enabled);
+    if (enabled) {
+        countCacheSaveTimer->start();
+    } else {
+        countCacheSaveTimer->stop();
+        QFile::remove(m_store.siblingFilePath("commitcounts.json"));
+    }
+}
+
+void FetchCore::setProbeBeforeFetch(bool enabled)
+{
+    m_probeBeforeFetch = enabled;
+    QSettings().setValue("probeBeforeFetch", enabled);
+    QMetaObject::invokeMethod(fetchWorker, "setProbeBeforeFetch", Qt::QueuedConnection, Q_ARG(bool, enabled));
+}
+
+void FetchCore::fetchAll()
+{
+    if (!fetchThread->isRunning()) {
+        emit logMessage(LogLevel::Error, "Error: Fetch worker thread is not running");
+        return;
+    }
+
+    emit logMessage(LogLevel::Info, "Starting fetch for all enabled repositories...");
+    for (GitRepository& repo : m_repositories) {
+        if (repo.enabled) {
+            enqueueFetch(repo, FetchScheduler::Priority::Background);
+        }
+    }
+}
+
+void FetchCore::enqueueFetch(GitRepository& repo, FetchScheduler::Priority priority)
+{
+    if (!fetchScheduler->enqueue(repo, priority)) {
+        return; // already fetching; the running fetch will bring it up to date
+    }
+    // Show repositories held back by the concurrency limits as waiting.
+    if (!fetchScheduler->isInFlight(repo.id) && repo.status != FetchStatus::Queued) {
+        repo.status = FetchStatus::Queued;
+        emit repositoryStatusChanged(repo.id);
+    }
+}
+
+void FetchCore::performScheduledFetch(RepositoryId repoId)
+{
+    if (!m_autoFetch) return;
+
+    GitRepository* repo = repository(repoId);
+    if (repo && repo->enabled) {
+        enqueueFetch(*repo, FetchScheduler::Priority::Background);
+    }
+}
+
+void FetchCore::onFetchStarted(RepositoryId repoId)
+{
+    if (GitRepository* repo = repository(repoId)) {
+        emit logMessage(LogLevel::Info, QString("Started fetching: %1").arg(repo->name));
+        repo->status = FetchStatus::Fetching;
+        emit repositoryStatusChanged(repoId);
+    }
+}
+
+void FetchCore::onFetchProgress(RepositoryId repoId, const QString& remoteName, const FetchProgress& progress)
+{
+    if (GitRemote* target = remote(repoId, remoteName)) {
+        target->progressText = progress.summary();
+        if (progress.bytes >= 0) {
+            target->bytesReceived = progress.bytes;
+        }
+        emit remoteChanged(repoId, remoteName);
+    }
+}
+
+void FetchCore::onRemoteStatusesChanged(const QList<RemoteStatusUpdate>& updates)
+{
+    for (const RemoteStatusUpdate& update : updates) {
+        applyRemoteStatus(update.repoId, update.remoteName, update.status);
+    }
+}
+
+void FetchCore::applyRemoteStatus(RepositoryId repoId, const QString& remoteName, FetchStatus status)
+{
+    GitRemote* target = remote(repoId, remoteName);
+    if (!target) {
+        return;
+    }
+
+    const bool wasFetching = (target->status == FetchStatus::Fetching);
+    target->status = status;
+    if (status == FetchStatus::Fetching) {
+        target->fetchStartMs = QDateTime::currentMSecsSinceEpoch();
+        target->progressText.clear();
+        target->bytesReceived = 0;
+        emit remoteFetchStarted(repoId, remoteName);
+    } else {
+        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+        if (status == FetchStatus::Success || status == FetchStatus::UpToDate) {
+            target->lastFetch = QDateTime::fromMSecsSinceEpoch(nowMs).toString(Qt::ISODate);
+        }
+        if (status != FetchStatus::Queued && status != FetchStatus::Ready) {
+            m_runtimeState.recordRemote(repository(repoId)->localPath, remoteName, status, nowMs);
+            scheduleRuntimeStateSave();
+        }
+        // Record what the fetch transferred so slow or heavy remotes stand
+        // out in the log.
+        if (wasFetching && target->bytesReceived > 0 && target->fetchStartMs > 0) {
+            const qint64 elapsedMs = qMax<qint64>(1, QDateTime::currentMSecsSinceEpoch() - target->fetchStartMs);
+            emit logMessage(LogLevel::Info, QString("%1/%2: received %3 in %4 s (%5/s)")
+                                                .arg(repository(repoId)->name, remoteName, FetchProgress::formatBytes(double(target->bytesReceived)))
+                                                .arg(elapsedMs / 1000.0, 0, 'f', 1)
+                                                .arg(FetchProgress::formatBytes(target->bytesReceived * 1000.0 / elapsedMs)));
+        }
+        target->progressText.clear();
+    }
+    emit remoteChanged(repoId, remoteName);
+}
+
+void FetchCore::onNewTagsFound(RepositoryId repoId, const QStringList& tags)
+{
+    if (const GitRepository* repo = repository(repoId)) {
+        emit logMessage(LogLevel::Info, QString("🏷 New tag%1 in %2: %3").arg(tags.size() > 1 ? "s" : "", repo->name, tags.join(", ")));
+        QMetaObject::invokeMethod(fetchJournal, "recordNewTags", Qt::QueuedConnection,
+                                  Q_ARG(QString, repo->localPath),
+                                  Q_ARG(qint64, QDateTime::currentMSecsSinceEpoch()),
+                                  Q_ARG(QStringList, tags));
+        emit newTagsFound(repoId, tags);
+    }
+}
+
+void FetchCore::onExternalRepositoryChanged(RepositoryId repoId)
+{
+    if (GitRepository* repo = repository(repoId)) {
+        calculateCommitCountsAsync(*repo);
+    }
+}
+
+void FetchCore::onFetchFinished(RepositoryId repoId, bool success, const QString& message)
+{
+    // Status and last-fetch time go to the runtime state, not the config, so
+    // there is no need to rewrite the config on fetch completion.
+    // Success or not, the next scheduled attempt is one interval from now.
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    fetchPlanner->markFetched(repoId, nowMs);
+
+    if (GitRepository* repo = repository(repoId)) {
+        emit logMessage(success ? LogLevel::Info : LogLevel::Error,
+                        QString("%1 %2: %3").arg(success ? "✓" : "✗", repo->name, message));
+        repo->status = success ? FetchStatus::Success : FetchStatus::Error;
+        if (success) {
+            repo->lastFetch = QDateTime::fromMSecsSinceEpoch(nowMs).toString(Qt::ISODate);
+        }
+        m_runtimeState.recordRepository(repo->localPath, success, nowMs);
+        scheduleRuntimeStateSave();
+        emit repositoryStatusChanged(repoId);
+        // The fetch just updated the remote-tracking refs, so the standing
+        // ahead/behind counts are stale (and would also be stale after an
+        // external rebase of the local branch). Recompute them now.
+        calculateCommitCountsAsync(*repo);
+    }
+}
+
+void FetchCore::onFetchError(RepositoryId repoId, const QString& errorMessage)
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    fetchPlanner->markFetched(repoId, nowMs);
+
+    if (GitRepository* repo = repository(repoId)) {
+        emit logMessage(LogLevel::Error, QString("✗ Error fetching %1: %2").arg(repo->name, errorMessage));
+        repo->status = FetchStatus::Error;
+        m_runtimeState.recordRepository(repo->localPath, false, nowMs);
+        scheduleRuntimeStateSave();
+        emit repositoryStatusChanged(repoId);
+    }
+}
+
+void FetchCore::setCommitCounts(RepositoryId repoId, const QString& remoteName, int commitsAhead, int commitsBehind)
+{
+    if (GitRemote* target = remote(repoId, remoteName)) {
+        target->commitsAhead = commitsAhead;
+        target->commitsBehind = commitsBehind;
+        emit remoteChanged(repoId, remoteName);
+    }
+}
+
+void FetchCore::calculateCommitCounts(GitRepository& repo)
+{
+    if (!GitUtils::isRepositoryValid(repo.localPath)) {
+        return;
+    }
+
+    QStringList remoteNames;
+    for (const GitRemote& remote : repo.remotes) {
+        remoteNames.append(remote.name);
+    }
+    applyCommitCounts(repo.id, GitUtils::calculateAllRemoteCommitCounts(repo.localPath, repo.branch, remoteNames, &m_countCache));
+}
+
+void FetchCore::calculateCommitCountsAsync(const GitRepository& repo)
+{
+    // Capture an immutable snapshot of everything the background thread needs.
+    // The worker never touches the shared repository list; it computes into
+    // local copies and posts the results back to the main thread, which owns the
+    // list. This avoids data races and dangling pointers if the list is mutated
+    // (add/remove/scan) while the calculation is running.
+    const RepositoryId repoId = repo.id;
+    const QString repoPath = repo.localPath;
+    const QString branch = repo.branch;
+
+    QStringList remoteNames;
+    remoteNames.reserve(repo.remotes.size());
+    for (const GitRemote& remote : repo.remotes) {
+        remoteNames.append(remote.name);
+    }
+
+    [[maybe_unused]] QFuture<void> future = QtConcurrent::run(countPool, [this, repoId, repoPath, branch, remoteNames]() {
+        if (!GitUtils::isRepositoryValid(repoPath)) {
+            return;
+        }
+
+        // Every remote is answered in one pass and delivered as one batch to
+        // the main thread, which owns the repository list.
+        const QList<GitUtils::RemoteCommitCounts> counts =
+            GitUtils::calculateAllRemoteCommitCounts(repoPath, branch, remoteNames, &m_countCache);
+        QMetaObject::invokeMethod(this, [this, repoId, counts]() {
+            applyCommitCounts(repoId, counts);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FetchCore::applyCommitCounts(RepositoryId repoId, const QList<GitUtils::RemoteCommitCounts>& counts)
+{
+    const GitRepository* repo = repository(repoId);
+    for (const GitUtils::RemoteCommitCounts& c : counts) {
+        setCommitCounts(repoId, c.remoteName, c.ahead, c.behind);
+        if (repo && !c.remoteSha.isEmpty()) {
+            m_runtimeState.recordRemoteSha(repo->localPath, c.remoteName, c.remoteSha);
+        }
+    }
+    if (m_runtimeState.isDirty()) {
+        scheduleRuntimeStateSave();
+    }
+    if (m_persistCounts && m_countCache.isDirty() && !countCacheSaveTimer->isActive()) {
+        countCacheSaveTimer->start();
+    }
+}
+
+void FetchCore::loadRepositories()
+{
+    RepositoryStore::LoadResult result = m_store.load();
+    for (const auto& [level, message] : std::as_const(result.messages)) {
+        emit logMessage(level, message);
+    }
+
+    m_repositories = result.repositories;
+    // Restore last-fetch times and outcomes before the planner sees them.
+    m_runtimeState.load(m_store.siblingFilePath("runtime-state.json"));
+    m_runtimeState.apply(m_repositories);
+    reindex();
+
+    // Seed the counts from the persisted cache so they show right away instead
+    // of 0/0; resolving the tips is a few file reads per repository.
+    if (m_persistCounts) {
+        m_countCache.load(m_store.siblingFilePath("commitcounts.json"));
+        for (GitRepository& repo : m_repositories) {
+            QStringList remoteNames;
+            for (const GitRemote& remote : repo.remotes) {
+                remoteNames.append(remote.name);
+            }
+            const QList<GitUtils::RemoteCommitCounts> counts =
+                GitUtils::cachedRemoteCommitCounts(repo.localPath, repo.branch, remoteNames, m_countCache);
+            for (int i = 0; i < counts.size() && i < repo.remotes.size(); ++i) {
+                if (counts[i].valid) {
+                    repo.remotes[i].commitsAhead = counts[i].ahead;
+                    repo.remotes[i].commitsBehind = counts[i].behind;
+                }
+            }
+        }
+    }
+
+    // Calculate commit counts for loaded repositories asynchronously; pairs
+    // already in the cache cost a ref read rather than a walk.
+    for (const GitRepository& repo : m_repositories) {
+        calculateCommitCountsAsync(repo);
+    }
+}
+
+void FetchCore::saveCommitCountCache()
+{
+    if (!m_persistCounts || !m_countCache.isDirty()) {
+        return;
+    }
+    QString error;
+    if (!m_countCache.save(m_store.siblingFilePath("commitcounts.json"), &error)) {
+        emit logMessage(LogLevel::Error, QString("Failed to save commit count cache: %1").arg(error));
+    }
+}
+
+void FetchCore::scheduleStatusSnapshot()
+{
+    if (!snapshotSaveTimer->isActive()) {
+        snapshotSaveTimer->start();
+    }
+}
+
+void FetchCore::saveStatusSnapshot()
+{
+    snapshotSaveTimer->stop();
+    QString error;
+    const bool saved = RepositoryStore::writeFileAtomically(StatusSnapshot::defaultFilePath(),
+                                                            StatusSnapshot::serialize(m_repositories), &error);
+    // Report a failure once, not on every rewrite while it persists.
+    if (!saved && !m_snapshotFailed) {
+        emit logMessage(LogLevel::Error, QString("Failed to save status snapshot: %1").arg(error));
+    }
+    m_snapshotFailed = !saved;
+}
+
+void FetchCore::scheduleRuntimeStateSave()
+{
+    if (m_runtimeState.isDirty() && !runtimeStateSaveTimer->isActive()) {
+        runtimeStateSaveTimer->start();
+    }
+}
+
+void FetchCore::saveRuntimeState()
+{
+    runtimeStateSaveTimer->stop();
+    if (!m_runtimeState.isDirty()) {
+        return;
+    }
+    QString error;
+    const bool saved = m_runtimeState.save(m_store.siblingFilePath("runtime-state.json"), &error);
+    // Report a failure once, not on every retry while it persists.
+    if (!saved && !m_runtimeStateFailed) {
+        emit logMessage(LogLevel::Error, QString("Failed to save runtime state: %1").arg(error));
+    }
+    m_runtimeStateFailed = !saved;
+}
+
+void FetchCore::saveRepositories()
+{
+    QString error;
+    if (m_store.save(m_repositories, &error)) {
+        emit logMessage(LogLevel::Info, "Configuration saved");
+    } else {
+        emit logMessage(LogLevel::Error, QString("Failed to save configuration: %1").arg(error));
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef FETCHCORE_H
+#define FETCHCORE_H
+
+#include "commitcountcache.h"
+#include "fetchprogress.h"
+#include "fetchscheduler.h"
+#include "gitmodels.h"
+#include "gitutils.h"
+#include "repositorystore.h"
+#include "runtimestate.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class ControlServer;
+class FetchJournal;
+class FetchPlanner;
+class GitFetchWorker;
+struct RemoteStatusUpdate;
+class QThread;
+class QThreadPool;
+class QTimer;
+class RepoWatcher;
+
+/**
+ * Everything that keeps the tracked repositories fetched, without any UI: the
+ * repository list and its store, the fetch schedule (FetchPlanner), admission
+ * control (FetchScheduler), the fetch worker and its thread, the filesystem
+ * watcher and the commit-count cache. Needs only QCoreApplication, so the
+ * window and the headless daemon share it.
+ *
+ * The core owns the repository list. Front ends read it directly, call
+ * syncRepositories() after changing which repositories are tracked, and follow
+ * value changes through the signals below. Repositories are identified by
+ * their id (GitRepository::id), which syncRepositories() assigns; lookups by
+ * id go through a hash index.
+ *
+ * Settings are read from QSettings by start(); each setter applies its value
+ * and persists it. start() also opens the local control socket
+ * (ControlServer) through which other tools query state and request fetches.
+ */
+class FetchCore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FetchCore(QObject *parent = nullptr);
+    ~FetchCore();
+
+    /**
+     * Load settings and repositories, start the schedule if auto-fetch is on
+     * and open the control socket.
+     */
+    void start();
+
+    QList<GitRepository>& repositories() { return m_repositories; }
+    const QList<GitRepository>& repositories() const { return m_repositories; }
+    /** The tracked repository with this id, or nullptr. O(1). */
+    GitRepository* repository(RepositoryId repoId);
+    /** The first tracked repository with this name (names may repeat), or nullptr. */
+    GitRepository* repositoryByName(const QString& repoName);
+    /**
+     * Stop tracking the repository with this id; false if there is none.
+     * Call syncRepositories() once done removing.
+     */
+    bool removeRepository(RepositoryId repoId);
+
+    /**
+     * After add/remove/edit: give new repositories an id and push the tracked
+     * set to the watcher and the schedule.
+     */
+    void syncRepositories();
+    void saveRepositories();
+    // Writes the commit-count cache to disk if it changed.
+    void saveCommitCountCache();
+    // Rewrites the status snapshot read by shell prompts (statussnapshot.h).
+    void saveStatusSnapshot();
+    // Writes last-fetch times and outcomes (runtimestate.h) if they changed.
+    void saveRuntimeState();
+
+    // Hands a repository to the fetch scheduler, marking it "Queued" while it
+    // waits for a free slot.
+    void enqueueFetch(GitRepository& repo, FetchScheduler::Priority priority);
+    void fetchAll();
+    void calculateCommitCounts(GitRepository& repo);
+    void calculateCommitCountsAsync(const GitRepository& repo);
+
+    int minimumInterval() const { return m_minimumInterval; }
+    void setMinimumInterval(int minutes);
+    int jitterPercent() const;
+    void setJitterPercent(int percent);
+    int fetchTimeout() const { return m_fetchTimeout; }
+    void setFetchTimeout(int seconds);
+    int connectionTimeout() const { return m_connectionTimeout; }
+    void setConnectionTimeout(int seconds);
+    int maxConcurrentFetches() const;
+    void setMaxConcurrentFetches(int count);
+    int hostLimit() const;
+    void setHostLimit(int limit);
+    bool autoFetch() const { return m_autoFetch; }
+    void setAutoFetch(bool enabled);
+    bool persistCommitCounts() const { return m_persistCounts; }
+    void setPersistCommitCounts(bool enabled);
+    bool probeBeforeFetch() const { return m_probeBeforeFetch; }
+    void setProbeBeforeFetch(bool enabled);
+
+signals:
+    void logMessage(LogLevel level, const QString& message);
+    // A repository's status or last-fetch time changed.
+    void repositoryStatusChanged(RepositoryId repoId);
+    // A remote's status, progress or commit counts changed.
+    void remoteChanged(RepositoryId repoId, const QString& remoteName);
+    void remoteFetchStarted(RepositoryId repoId, const QString& remoteName);
+    void newTagsFound(RepositoryId repoId, const QStringList& tags);
+    // How many fetches probe-first mode has skipped this session.
+    void probeSkipsChanged(int totalSkips);
+
+private slots:
+    void performScheduledFetch(RepositoryId repoId);
+    void onFetchStarted(RepositoryId repoId);
+    void onFetchProgress(RepositoryId repoId, const QString& remoteName, const FetchProgress& progress);
+    void onRemoteStatusesChanged(const QList<RemoteStatusUpdate>& updates);
+    void onFetchFinished(RepositoryId repoId, bool success, const QString& message);
+    void onFetchError(RepositoryId repoId, const QString& errorMessage);
+    void onNewTagsFound(RepositoryId repoId, const QStringList& tags);
+    // Recomputes a repository's commit counts after an external git change.
+    void onExternalRepositoryChanged(RepositoryId repoId);
+    void scheduleStatusSnapshot();
+    void scheduleRuntimeStateSave();
+
+private:
+    void loadSettings();
+    void loadRepositories();
+    // Assigns ids to repositories that have none and rebuilds m_indexById.
+    void reindex();
+    void applyRemoteStatus(RepositoryId repoId, const QString& remoteName, FetchStatus status);
+    // Applies one repository's batch of per-remote counts on the main thread.
+    void applyCommitCounts(RepositoryId repoId, const QList<GitUtils::RemoteCommitCounts>& counts);
+    void setCommitCounts(RepositoryId repoId, const QString& remoteName, int commitsAhead, int commitsBehind);
+    GitRemote* remote(RepositoryId repoId, const QString& remoteName);
+
+    QThread *fetchThread;
+    GitFetchWorker *fetchWorker;
+    QThread *journalThread;
+    FetchJournal *fetchJournal;     // on journalThread; fed by fetchWorker directly
+    FetchScheduler *fetchScheduler; // per-host / global admission control in front of fetchWorker
+    FetchPlanner *fetchPlanner;     // per-repository due times for background fetches
+    RepoWatcher *repoWatcher;
+    QThreadPool *countPool;         // commit count calculations; drained before destruction
+    QTimer *countCacheSaveTimer;    // debounces writes of m_countCache
+    QTimer *snapshotSaveTimer;      // throttles status snapshot rewrites
+    QTimer *runtimeStateSaveTimer;  // debounces writes of m_runtimeState
+    ControlServer *controlServer;
+
+    RepositoryStore m_store;
+    QList<GitRepository> m_repositories;
+    QHash<RepositoryId, int> m_indexById; // id -> position in m_repositories
+    RepositoryId m_nextId = 1;
+    CommitCountCache m_countCache; // ahead/behind memoized by (local, remote) SHA pair
+    RuntimeState m_runtimeState;   // last fetch times and outcomes, kept across restarts
+
+    int m_minimumInterval = 60;
+    int m_fetchTimeout = 300;
+    int m_connectionTimeout = 5;
+    bool m_autoFetch = true;
+    bool m_persistCounts = true;
+    bool m_probeBeforeFetch = false;
+    bool m_snapshotFailed = false;
+    bool m_runtimeStateFailed = false;
+};
+
+#endif // FETCHCORE_H
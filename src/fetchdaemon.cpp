@@ -0,0 +1,82 @@
+#include "fetchdaemon.h"
+#include "fetchcore.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QTextStream>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_UNIX
+int signalFds[2] = {-1, -1};
+
+// Only async-signal-safe work here: wake the event loop, which quits.
+void handleTerminationSignal(int)
+{
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = ::write(signalFds[0], &byte, sizeof(byte));
+}
+
+void installTerminationHandlers(QCoreApplication& app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalFds) != 0) {
+        return; // default handlers still terminate, just without saving
+    }
+    auto *notifier = new QSocketNotifier(signalFds[1], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, [notifier]() {
+        notifier->setEnabled(false);
+        char byte;
+        [[maybe_unused]] const ssize_t readBytes = ::read(signalFds[1], &byte, sizeof(byte));
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = handleTerminationSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+#endif
+
+} // namespace
+
+int runDaemon(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Same names as the window so both use the same QSettings and data files.
+    app.setApplicationName("FetchDeezNutz");
+    app.setApplicationVersion("1.0");
+    app.setOrganizationName("FetchDeezNutz");
+
+#ifdef Q_OS_UNIX
+    installTerminationHandlers(app);
+#endif
+
+    QTextStream out(stdout);
+    {
+        FetchCore core;
+        QObject::connect(&core, &FetchCore::logMessage, &app, [&out](LogLevel level, const QString& message) {
+            const char *tag = level == LogLevel::Error ? "error: " : level == LogLevel::Warning ? "warning: " : "";
+            out << QString("[%1] %2%3").arg(QDateTime::currentDateTime().toString("hh:mm:ss"), tag, message) << Qt::endl;
+        });
+
+        core.start();
+        out << QString("Tracking %1 repositories%2")
+                   .arg(core.repositories().size())
+                   .arg(core.autoFetch() ? QString() : QString(" (auto-fetch is disabled)"))
+            << Qt::endl;
+
+        const int result = app.exec();
+        out << "Shutting down" << Qt::endl;
+        return result; // ~FetchCore stops fetching and saves state
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef FETCHDAEMON_H
+#define FETCHDAEMON_H
+
+/**
+ * Headless entry point (`fetchdeeznutz-daemon`, or `fetchdeeznutz --daemon`
+ * from the GUI binary): runs FetchCore under a QCoreApplication, with no
+ * widgets, tray or display connection. It reads the same settings and
+ * repository list as the window and writes the activity log to stdout.
+ * SIGINT/SIGTERM shut it down cleanly, saving state on the way out.
+ *
+ * Run either the daemon or the window, not both: they would fetch the same
+ * repositories and overwrite each other's saved state.
+ */
+int runDaemon(int argc, char *argv[]);
+
+#endif // FETCHDAEMON_H
@@ -8,96 +8,65 @@
 #include <QContextMenuEvent>
 #include <QFileInfo>
 #include <QMap>
-#include <QMetaType>
-#include <QMutexLocker>
-#include <QtConcurrent>
 #include <QScrollBar>
+#include <QSignalBlocker>
 #include <QItemSelectionModel>
 
+namespace {
+// Messages kept in the activity log; the oldest are dropped beyond this.
+constexpr int kLogCapacity = 10000;
+} // namespace
+
 FetchDeeznutzWindow::FetchDeeznutzWindow(QWidget *parent)
     : QMainWindow(parent)
-    , fetchTimer(new QTimer(this))
     , fetchTicker(new QTimer(this))
-    , fetchThread(new QThread(this))
-    , fetchWorker(new GitFetchWorker())
-    , repoWatcher(new RepoWatcher(this))
+    , core(new FetchCore(this))
+    , repoScanner(new RepositoryScanner(this))
+    , repoOnboarder(new RepositoryOnboarder(this))
 {
     setWindowTitle("Git Repository Fetcher");
     setMinimumSize(800, 600);
 
-    // Register types with Qt's meta-object system (must be done before moving to thread)
-    qRegisterMetaType<GitRemote>("GitRemote");
-    qRegisterMetaType<GitRepository>("GitRepository");
-    
-    // Verify registration (using QMetaType::fromType for Qt6 compatibility)
-    if (!QMetaType::fromType<GitRepository>().isValid()) {
-        qWarning() << "Failed to register GitRepository meta type";
-    }
-    if (!QMetaType::fromType<GitRemote>().isValid()) {
-        qWarning() << "Failed to register GitRemote meta type";
-    }
-    
-    // Setup background thread and worker
-    fetchWorker->moveToThread(fetchThread);
-    connect(fetchThread, &QThread::finished, fetchWorker, &GitFetchWorker::deleteLater);
-    connect(fetchWorker, &GitFetchWorker::fetchStarted, this, &FetchDeeznutzWindow::onBackgroundFetchStarted);
-    connect(fetchWorker, &GitFetchWorker::fetchProgress, this, &FetchDeeznutzWindow::onBackgroundFetchProgress);
-    connect(fetchWorker, &GitFetchWorker::remoteStatusChanged, this, &FetchDeeznutzWindow::onRemoteStatusChanged);
-    connect(fetchWorker, &GitFetchWorker::fetchFinished, this, &FetchDeeznutzWindow::onBackgroundFetchFinished);
-    connect(fetchWorker, &GitFetchWorker::fetchError, this, &FetchDeeznutzWindow::onBackgroundFetchError);
-    connect(fetchWorker, &GitFetchWorker::commitCountsUpdated, this, &FetchDeeznutzWindow::onCommitCountsUpdated);
-    connect(fetchWorker, &GitFetchWorker::newTagsFound, this, &FetchDeeznutzWindow::onNewTagsFound);
-
-    // Watch tracked repos for external git changes (commit/checkout/rebase) so
-    // their ahead/behind counts stay live without waiting for a fetch.
-    connect(repoWatcher, &RepoWatcher::repositoryChanged, this, &FetchDeeznutzWindow::onExternalRepositoryChanged);
-    fetchThread->start();
-    
-    // Initial timeout values will be set in loadSettings()
+    connect(repoScanner, &RepositoryScanner::repositoriesFound, this, &FetchDeeznutzWindow::onScanRepositoriesFound);
+    connect(repoScanner, &RepositoryScanner::finished, this, &FetchDeeznutzWindow::onScanFinished);
+    connect(repoOnboarder, &RepositoryOnboarder::repositoriesProbed, this, &FetchDeeznutzWindow::onRepositoriesProbed);
+    connect(repoOnboarder, &RepositoryOnboarder::idle, this, &FetchDeeznutzWindow::finishScanIfIdle);
 
     setupUI();
     setupSystemTray();
-    loadSettings(); // Load settings before loading repositories
-    loadRepositories();
-    updateRepositoryTree();
 
-    // Connect timer for scheduled fetching
-    connect(fetchTimer, &QTimer::timeout, this, &FetchDeeznutzWindow::performScheduledFetch);
+    // The fetching itself lives in the core; the window mirrors its state.
+    connect(core, &FetchCore::logMessage, this, &FetchDeeznutzWindow::logMessage);
+    connect(core, &FetchCore::repositoryStatusChanged, repositoryModel, &RepositoryTreeModel::updateRepositoryStatus);
+    connect(core, &FetchCore::remoteChanged, repositoryModel, &RepositoryTreeModel::updateRemoteCounts);
+    connect(core, &FetchCore::remoteFetchStarted, this, &FetchDeeznutzWindow::onRemoteFetchStarted);
+    connect(core, &FetchCore::newTagsFound, this, &FetchDeeznutzWindow::onNewTagsFound);
+    connect(core, &FetchCore::probeSkipsChanged, this, &FetchDeeznutzWindow::onProbeSkipsChanged);
+
+    // Loads settings and repositories and starts the schedule if auto-fetch
+    // is on. Repositories without a recent fetch come due within the first few
+    // seconds, spread out rather than all at once.
+    core->start();
+    loadSettings();
+    updateRepositoryTree();
 
     // 1s heartbeat that animates the elapsed counter on in-flight remotes; only
     // runs while at least one remote is actively fetching.
     fetchTicker->setInterval(1000);
     connect(fetchTicker, &QTimer::timeout, this, &FetchDeeznutzWindow::updateFetchElapsed);
 
-    // Start timer based on loaded settings
-    if (autoFetchCheckBox->isChecked()) {
-        fetchTimer->start(globalIntervalSpinBox->value() * 60000);
-    }
-
     // Show the window on launch unless the user opted to start in the tray.
     if (!startMinimizedCheckBox->isChecked()) {
         showWindow();
     }
-
-    // Fetch immediately on launch rather than waiting a full interval, so the
-    // status is fresh as soon as the app comes up. Deferred to the event loop so
-    // the worker thread and UI are fully ready first.
-    if (autoFetchCheckBox->isChecked()) {
-        QTimer::singleShot(0, this, &FetchDeeznutzWindow::fetchAll);
-    }
 }
 
 FetchDeeznutzWindow::~FetchDeeznutzWindow()
 {
-    saveSettings(); // persist window geometry (and settings) on quit
-    saveRepositories();
-    
-    // Clean up background thread
-    if (fetchWorker) {
-        fetchWorker->stopFetching();
-    }
-    fetchThread->quit();
-    fetchThread->wait();
+    saveSettings(); // persist window geometry on quit
+    // Stop fetching and write the repository list and caches while the log
+    // widget can still receive the core's messages.
+    delete core;
 }
 
 void FetchDeeznutzWindow::setupUI()
@@ -114,7 +83,7 @@ void FetchDeeznutzWindow::setupUI()
     QGroupBox *repoGroup = new QGroupBox("Repositories");
     QVBoxLayout *repoLayout = new QVBoxLayout(repoGroup);
 
-    repositoryModel = new RepositoryTreeModel(&repositories, this);
+    repositoryModel = new RepositoryTreeModel(core, this);
     repositoryView = new QTreeView();
     repositoryView->setModel(repositoryModel);
     repositoryView->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -179,6 +148,27 @@ void FetchDeeznutzWindow::setupUI()
     connectionTimeoutSpinBox->setSuffix(" seconds");
     connect(connectionTimeoutSpinBox, &QSpinBox::valueChanged, this, &FetchDeeznutzWindow::onConnectionTimeoutChanged);
 
+    hostLimitSpinBox = new QSpinBox();
+    hostLimitSpinBox->setRange(1, 32);
+    hostLimitSpinBox->setValue(core->hostLimit());
+    hostLimitSpinBox->setSuffix(" remotes");
+    hostLimitSpinBox->setToolTip("Maximum number of remotes fetched from the same server at once.");
+    connect(hostLimitSpinBox, &QSpinBox::valueChanged, this, &FetchDeeznutzWindow::onHostLimitChanged);
+
+    parallelFetchesSpinBox = new QSpinBox();
+    parallelFetchesSpinBox->setRange(1, 256);
+    parallelFetchesSpinBox->setValue(core->maxConcurrentFetches());
+    parallelFetchesSpinBox->setToolTip("Maximum number of remotes fetched at the same time, across all servers.");
+    connect(parallelFetchesSpinBox, &QSpinBox::valueChanged, this, &FetchDeeznutzWindow::onParallelFetchesChanged);
+
+    jitterSpinBox = new QSpinBox();
+    jitterSpinBox->setRange(0, 50);
+    jitterSpinBox->setValue(core->jitterPercent());
+    jitterSpinBox->setSuffix(" %");
+    jitterSpinBox->setToolTip("Randomly shortens or stretches each repository's interval by up to this much, "
+                              "so fetches don't all land at the same moment.");
+    connect(jitterSpinBox, &QSpinBox::valueChanged, this, &FetchDeeznutzWindow::onJitterChanged);
+
     autoFetchCheckBox = new QCheckBox("Enable Auto Fetch");
     autoFetchCheckBox->setChecked(true);
     connect(autoFetchCheckBox, &QCheckBox::toggled, this, &FetchDeeznutzWindow::onAutoFetchToggled);
@@ -188,6 +178,17 @@ void FetchDeeznutzWindow::setupUI()
     startMinimizedCheckBox->setToolTip("When enabled, the app launches straight to the system tray instead of showing the window.");
     connect(startMinimizedCheckBox, &QCheckBox::toggled, this, &FetchDeeznutzWindow::saveSettings);
 
+    persistCountsCheckBox = new QCheckBox("Remember commit counts across restarts");
+    persistCountsCheckBox->setChecked(true);
+    persistCountsCheckBox->setToolTip("Keeps computed ahead/behind counts on disk so they show immediately on launch.");
+    connect(persistCountsCheckBox, &QCheckBox::toggled, this, &FetchDeeznutzWindow::onPersistCountsToggled);
+
+    probeBeforeFetchCheckBox = new QCheckBox("Probe remotes before fetching");
+    probeBeforeFetchCheckBox->setChecked(false);
+    probeBeforeFetchCheckBox->setToolTip("Lists each remote's refs first and skips the fetch when nothing has moved. "
+                                         "Cheaper for large repositories; costs an extra round trip when something changed.");
+    connect(probeBeforeFetchCheckBox, &QCheckBox::toggled, this, &FetchDeeznutzWindow::onProbeBeforeFetchToggled);
+
     // Initially update the enabled state of interval controls (will be updated again in loadSettings)
     updateAutoFetchControls();
 
@@ -197,8 +198,13 @@ void FetchDeeznutzWindow::setupUI()
     settingsLayout->addRow("Global Interval:", globalIntervalSpinBox);
     settingsLayout->addRow("Fetch Timeout:", fetchTimeoutSpinBox);
     settingsLayout->addRow("Connection Timeout:", connectionTimeoutSpinBox);
+    settingsLayout->addRow("Parallel Fetches:", parallelFetchesSpinBox);
+    settingsLayout->addRow("Per-host Limit:", hostLimitSpinBox);
+    settingsLayout->addRow("Schedule Jitter:", jitterSpinBox);
     settingsLayout->addRow("", autoFetchCheckBox);
     settingsLayout->addRow("", startMinimizedCheckBox);
+    settingsLayout->addRow("", persistCountsCheckBox);
+    settingsLayout->addRow("", probeBeforeFetchCheckBox);
     settingsLayout->addRow("", fetchAllButton);
 
     leftLayout->addWidget(settingsGroup);
@@ -221,10 +227,30 @@ void FetchDeeznutzWindow::setupUI()
     QGroupBox *logGroup = new QGroupBox("Activity Log");
     QVBoxLayout *logLayout = new QVBoxLayout(logGroup);
 
-    logTextEdit = new QTextEdit();
-    logTextEdit->setReadOnly(true);
-    logTextEdit->document()->setMaximumBlockCount(1000); // Limit log size
-    logLayout->addWidget(logTextEdit);
+    QHBoxLayout *logFilterLayout = new QHBoxLayout();
+    logFilterEdit = new QLineEdit();
+    logFilterEdit->setPlaceholderText("Filter by repository or text");
+    logFilterEdit->setClearButtonEnabled(true);
+    logLevelComboBox = new QComboBox();
+    logLevelComboBox->addItem("All messages");        // ActivityLogModel::Level::Info
+    logLevelComboBox->addItem("Warnings and errors"); // ActivityLogModel::Level::Warning
+    logLevelComboBox->addItem("Errors only");         // ActivityLogModel::Level::Error
+    logFilterLayout->addWidget(logFilterEdit, 1);
+    logFilterLayout->addWidget(logLevelComboBox);
+    logLayout->addLayout(logFilterLayout);
+
+    // A bounded ring of messages in a list view that only lays out the rows
+    // on screen, so a week of background fetches costs no more than an hour.
+    logModel = new ActivityLogModel(kLogCapacity, this);
+    logFilter = new ActivityLogFilter(this);
+    logView = new QListView();
+    logView->setModel(logModel);
+    logView->setUniformItemSizes(true);
+    logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    logLayout->addWidget(logView);
+    connect(logFilterEdit, &QLineEdit::textChanged, this, &FetchDeeznutzWindow::onLogFilterChanged);
+    connect(logLevelComboBox, &QComboBox::currentIndexChanged, this, &FetchDeeznutzWindow::onLogFilterChanged);
 
     // Vertical splitter: repository tree (top) vs. settings/status (bottom).
     leftSplitter = new QSplitter(Qt::Vertical);
@@ -305,10 +331,11 @@ void FetchDeeznutzWindow::addRepository()
                 }
             }
             
-            repositories.append(repo);
-            updateRepositoryTree();
-            saveRepositories();
-            logMessage(QString("Added repository: %1 with %2 remotes").arg(repo.name).arg(repo.remotes.size()));
+            core->repositories().append(repo);
+            core->syncRepositories(); // assigns the repository its id
+            revealRepository(repositoryModel->insertRepository(core->repositories().constLast().id));
+            core->saveRepositories();
+            logMessage(LogLevel::Info, QString("Added repository: %1 with %2 remotes").arg(repo.name).arg(repo.remotes.size()));
         } else {
             QMessageBox::warning(this, "Invalid Repository", "Name and at least one remote are required.");
         }
@@ -317,6 +344,14 @@ void FetchDeeznutzWindow::addRepository()
 
 void FetchDeeznutzWindow::addDirectory()
 {
+    // While a scan runs the button cancels it.
+    if (repoScanner->isRunning()) {
+        repoScanner->cancel();
+        repoOnboarder->cancel();
+        logMessage(LogLevel::Info, "Cancelling directory scan...");
+        return;
+    }
+
     QString directoryPath = QFileDialog::getExistingDirectory(
         this,
         "Select Directory to Scan for Git Repositories",
@@ -325,7 +360,7 @@ void FetchDeeznutzWindow::addDirectory()
     );
 
     if (!directoryPath.isEmpty()) {
-        logMessage(QString("Scanning directory: %1").arg(directoryPath));
+        logMessage(LogLevel::Info, QString("Scanning directory: %1").arg(directoryPath));
         scanDirectoryForRepositories(directoryPath);
     }
 }
@@ -338,10 +373,12 @@ void FetchDeeznutzWindow::editRepository()
         if (dialog.exec() == QDialog::Accepted) {
             GitRepository newRepo = dialog.getRepository();
             if (!newRepo.name.isEmpty() && !newRepo.remotes.isEmpty()) {
+                newRepo.id = repo->id; // same repository, edited
                 *repo = newRepo;
-                updateRepositoryTree();
-                saveRepositories();
-                logMessage(QString("Updated repository: %1 with %2 remotes").arg(repo->name).arg(repo->remotes.size()));
+                core->syncRepositories();
+                revealRepository(repositoryModel->updateRepository(repo->id));
+                core->saveRepositories();
+                logMessage(LogLevel::Info, QString("Updated repository: %1 with %2 remotes").arg(repo->name).arg(repo->remotes.size()));
             } else {
                 QMessageBox::warning(this, "Invalid Repository", "Name and at least one remote are required.");
             }
@@ -353,15 +390,19 @@ void FetchDeeznutzWindow::removeRepository()
 {
     GitRepository* repo = repositoryForIndex(repositoryView->currentIndex());
     if (repo) {
+        // The dialog runs an event loop that may change the list; hold on to
+        // the id rather than the pointer.
+        const RepositoryId repoId = repo->id;
         QString repoName = repo->name;
         int ret = QMessageBox::question(this, "Remove Repository",
                                        QString("Are you sure you want to remove '%1'?").arg(repoName),
                                        QMessageBox::Yes | QMessageBox::No);
-        if (ret == QMessageBox::Yes) {
-            repositories.removeOne(*repo);
-            updateRepositoryTree();
-            saveRepositories();
-            logMessage(QString("Removed repository: %1").arg(repoName));
+        if (ret == QMessageBox::Yes && core->repository(repoId)) {
+            repositoryModel->removeRepository(repoId);
+            core->removeRepository(repoId);
+            core->syncRepositories();
+            core->saveRepositories();
+            logMessage(LogLevel::Info, QString("Removed repository: %1").arg(repoName));
         }
     }
 }
@@ -383,7 +424,7 @@ void FetchDeeznutzWindow::removeDirectory()
     
     // Count repositories in this directory
     int repoCount = 0;
-    for (const GitRepository& repo : repositories) {
+    for (const GitRepository& repo : core->repositories()) {
         QString repoDirPath = QFileInfo(repo.localPath).absolutePath();
         if (repoDirPath == dirPath) {
             repoCount++;
@@ -401,20 +442,21 @@ void FetchDeeznutzWindow::removeDirectory()
     
     if (ret == QMessageBox::Yes) {
         // Remove all repositories in this directory
-        auto it = repositories.begin();
-        while (it != repositories.end()) {
+        auto it = core->repositories().begin();
+        while (it != core->repositories().end()) {
             QString repoDirPath = QFileInfo(it->localPath).absolutePath();
             if (repoDirPath == dirPath) {
-                logMessage(QString("Removed repository: %1").arg(it->name));
-                it = repositories.erase(it);
+                logMessage(LogLevel::Info, QString("Removed repository: %1").arg(it->name));
+                repositoryModel->removeRepository(it->id);
+                it = core->repositories().erase(it);
             } else {
                 ++it;
             }
         }
         
-        updateRepositoryTree();
-        saveRepositories();
-        logMessage(QString("Removed all repositories from directory: %1").arg(dirPath));
+        core->syncRepositories();
+        core->saveRepositories();
+        logMessage(LogLevel::Info, QString("Removed all repositories from directory: %1").arg(dirPath));
     }
 }
 
@@ -448,42 +490,16 @@ void FetchDeeznutzWindow::showContextMenu(const QPoint& pos)
 
 void FetchDeeznutzWindow::fetchSelected()
 {
-    if (!fetchWorker) {
-        logMessage("Error: Fetch worker is not initialized");
-        return;
-    }
-    
     GitRepository* repo = repositoryForIndex(repositoryView->currentIndex());
     if (repo) {
-        // Make a copy to ensure thread safety
-        GitRepository repoCopy = *repo;
-        // Use background worker for fetching
-        QMetaObject::invokeMethod(fetchWorker, "fetchRepository", Qt::QueuedConnection, Q_ARG(GitRepository, repoCopy));
+        // Manual requests jump ahead of any queued background fetches.
+        core->enqueueFetch(*repo, FetchScheduler::Priority::Manual);
     }
 }
 
 void FetchDeeznutzWindow::fetchAll()
 {
-    if (!fetchWorker) {
-        logMessage("Error: Fetch worker is not initialized");
-        return;
-    }
-    
-    if (!fetchThread || !fetchThread->isRunning()) {
-        logMessage("Error: Fetch worker thread is not running");
-        return;
-    }
-    
-    logMessage("Starting fetch for all enabled repositories...");
-    for (const GitRepository& repo : repositories) {
-        if (repo.enabled) {
-            // Make an explicit copy to ensure thread safety
-            GitRepository repoCopy = repo;
-            // Use QMetaObject::invokeMethod with queued connection
-            // This ensures the call happens in the worker thread
-            QMetaObject::invokeMethod(fetchWorker, "fetchRepository", Qt::QueuedConnection, Q_ARG(GitRepository, repoCopy));
-        }
-    }
+    core->fetchAll();
 }
 
 void FetchDeeznutzWindow::onRepositorySelectionChanged()
@@ -516,7 +532,7 @@ void FetchDeeznutzWindow::onRepositoryItemDoubleClicked(const QModelIndex& index
     }
     
     if (!trackingRemote) {
-        logMessage(QString("Repository %1: No fast-forwardable remote branch found").arg(repo->name));
+        logMessage(LogLevel::Warning, QString("Repository %1: No fast-forwardable remote branch found").arg(repo->name));
         return;
     }
 
@@ -534,199 +550,82 @@ void FetchDeeznutzWindow::onRepositoryItemDoubleClicked(const QModelIndex& index
         return;
     }
 
-    logMessage(QString("Fast-forwarding %1/%2 to %3...").arg(repo->name, repo->branch, trackingRemote->name));
+    logMessage(LogLevel::Info, QString("Fast-forwarding %1/%2 to %3...").arg(repo->name, repo->branch, trackingRemote->name));
     QString errorMessage;
     if (GitUtils::rebaseBranch(repo->localPath, repo->branch, trackingRemote->name, errorMessage)) {
-        logMessage(QString("✓ Successfully fast-forwarded %1/%2 to %3").arg(repo->name, repo->branch, trackingRemote->name));
+        logMessage(LogLevel::Info, QString("✓ Successfully fast-forwarded %1/%2 to %3").arg(repo->name, repo->branch, trackingRemote->name));
         // Recalculate commit counts after the update
-        calculateCommitCounts(*repo);
-        updateRepositoryTree();
+        core->calculateCommitCounts(*repo);
     } else {
-        logMessage(QString("✗ Failed to fast-forward %1/%2: %3").arg(repo->name, repo->branch, errorMessage));
+        logMessage(LogLevel::Error, QString("✗ Failed to fast-forward %1/%2: %3").arg(repo->name, repo->branch, errorMessage));
     }
 }
 
 void FetchDeeznutzWindow::onFetchIntervalChanged()
 {
-    saveSettings(); // Save settings when changed
-    if (autoFetchCheckBox->isChecked()) {
-        fetchTimer->setInterval(globalIntervalSpinBox->value() * 60000);
-        logMessage(QString("Auto-fetch interval changed to %1 minutes").arg(globalIntervalSpinBox->value()));
-    }
+    core->setMinimumInterval(globalIntervalSpinBox->value());
 }
 
-void FetchDeeznutzWindow::onFetchTimeoutChanged()
+void FetchDeeznutzWindow::onJitterChanged()
 {
-    int timeoutSeconds = fetchTimeoutSpinBox->value();
-    QMetaObject::invokeMethod(fetchWorker, "setTimeout", Qt::QueuedConnection, Q_ARG(int, timeoutSeconds));
-    logMessage(QString("Fetch timeout changed to %1 seconds").arg(timeoutSeconds));
+    core->setJitterPercent(jitterSpinBox->value());
 }
 
-void FetchDeeznutzWindow::onConnectionTimeoutChanged()
+void FetchDeeznutzWindow::onFetchTimeoutChanged()
 {
-    saveSettings(); // Save settings when changed
-    int timeoutSeconds = connectionTimeoutSpinBox->value();
-    QMetaObject::invokeMethod(fetchWorker, "setConnectionTimeout", Qt::QueuedConnection, Q_ARG(int, timeoutSeconds));
-    logMessage(QString("Connection timeout changed to %1 seconds").arg(timeoutSeconds));
+    core->setFetchTimeout(fetchTimeoutSpinBox->value());
 }
 
-void FetchDeeznutzWindow::onAutoFetchToggled()
+void FetchDeeznutzWindow::onConnectionTimeoutChanged()
 {
-    saveSettings(); // Save settings when changed
-    updateAutoFetchControls(); // Update enabled state of interval controls
-    if (autoFetchCheckBox->isChecked()) {
-        startScheduledFetch();
-        logMessage("Auto-fetch enabled");
-    } else {
-        stopScheduledFetch();
-        logMessage("Auto-fetch disabled");
-    }
+    core->setConnectionTimeout(connectionTimeoutSpinBox->value());
 }
 
-void FetchDeeznutzWindow::performScheduledFetch()
+void FetchDeeznutzWindow::onProbeBeforeFetchToggled()
 {
-    if (!autoFetchCheckBox->isChecked()) return;
-
-    QDateTime now = QDateTime::currentDateTime();
-    for (GitRepository& repo : repositories) {
-        if (!repo.enabled) continue;
-
-        QDateTime lastFetch = QDateTime::fromString(repo.lastFetch, Qt::ISODate);
-        if (!lastFetch.isValid() || lastFetch.addSecs(repo.fetchInterval * 60) <= now) {
-            // Use background worker for scheduled fetching
-            QMetaObject::invokeMethod(fetchWorker, "fetchRepository", Qt::QueuedConnection, Q_ARG(GitRepository, repo));
-        }
-    }
+    core->setProbeBeforeFetch(probeBeforeFetchCheckBox->isChecked());
 }
 
-void FetchDeeznutzWindow::onBackgroundFetchStarted(const QString& repoName)
+void FetchDeeznutzWindow::onProbeSkipsChanged(int totalSkips)
 {
-    logMessage(QString("Started fetching: %1").arg(repoName));
-    
-    // Find the repository and update its status
-    for (GitRepository& repo : repositories) {
-        if (repo.name == repoName) {
-            repo.status = "Fetching...";
-            repositoryModel->updateRepositoryStatus(repoName);
-            break;
-        }
-    }
+    probeBeforeFetchCheckBox->setText(QString("Probe remotes before fetching (%1 skipped)").arg(totalSkips));
 }
 
-void FetchDeeznutzWindow::onBackgroundFetchProgress(const QString& repoName, const QString& remoteName, int progress)
+void FetchDeeznutzWindow::onAutoFetchToggled()
 {
-    // Update progress if needed
-    Q_UNUSED(repoName);
-    Q_UNUSED(remoteName);
-    Q_UNUSED(progress);
+    updateAutoFetchControls(); // Update enabled state of interval controls
+    core->setAutoFetch(autoFetchCheckBox->isChecked());
 }
 
-void FetchDeeznutzWindow::onRemoteStatusChanged(const QString& repoName, const QString& remoteName, const QString& status)
+void FetchDeeznutzWindow::onRemoteFetchStarted()
 {
-    for (GitRepository& repo : repositories) {
-        if (repo.name != repoName) {
-            continue;
-        }
-        for (GitRemote& remote : repo.remotes) {
-            if (remote.name == remoteName) {
-                remote.status = status;
-                if (status == "Fetching...") {
-                    remote.fetchStartMs = QDateTime::currentMSecsSinceEpoch();
-                    if (!fetchTicker->isActive()) {
-                        fetchTicker->start();
-                    }
-                } else if (status == "Success") {
-                    remote.lastFetch = QDateTime::currentDateTime().toString(Qt::ISODate);
-                }
-                repositoryModel->updateRemoteCounts(repoName, remoteName);
-                break;
-            }
-        }
-        break;
+    if (!fetchTicker->isActive()) {
+        fetchTicker->start();
     }
 }
 
 void FetchDeeznutzWindow::updateFetchElapsed()
 {
-    if (repositoryModel->refreshActiveRemotes() == 0) {
+    // Rows in collapsed directories or scrolled out of view have no visual
+    // rect inside the viewport; they show the current time once painted.
+    const QRect viewport = repositoryView->viewport()->rect();
+    const int active = repositoryModel->refreshActiveRemotes([this, &viewport](const QModelIndex& index) {
+        return repositoryView->visualRect(index).intersects(viewport);
+    });
+    if (active == 0) {
         fetchTicker->stop();
     }
 }
 
-void FetchDeeznutzWindow::onNewTagsFound(const QString& repoName, const QStringList& tags)
+void FetchDeeznutzWindow::onNewTagsFound(RepositoryId repoId, const QStringList& tags)
 {
-    const QString tagList = tags.join(", ");
-    logMessage(QString("🏷 New tag%1 in %2: %3").arg(tags.size() > 1 ? "s" : "", repoName, tagList));
-
-    if (trayIcon && QSystemTrayIcon::supportsMessages()) {
-        const QString title = QString("New tag%1 in %2").arg(tags.size() > 1 ? "s" : "", repoName);
+    // Already logged by the core; also raise a tray notification.
+    const GitRepository* repo = core->repository(repoId);
+    if (repo && trayIcon && QSystemTrayIcon::supportsMessages()) {
+        const QString title = QString("New tag%1 in %2").arg(tags.size() > 1 ? "s" : "", repo->name);
         // Long timeout hint so the notification stays around until dismissed
         // (the actual persistence is ultimately up to the platform's notifier).
-        trayIcon->showMessage(title, tagList, QSystemTrayIcon::Information, 24 * 60 * 60 * 1000);
-    }
-}
-
-void FetchDeeznutzWindow::onExternalRepositoryChanged(const QString& repoName)
-{
-    for (GitRepository& repo : repositories) {
-        if (repo.name == repoName) {
-            calculateCommitCountsAsync(repo);
-            break;
-        }
-    }
-}
-
-void FetchDeeznutzWindow::onBackgroundFetchFinished(const QString& repoName, bool success, const QString& message)
-{
-    logMessage(QString("%1 %2: %3").arg(success ? "✓" : "✗", repoName, message));
-    
-    // Update the in-memory status / last-fetch time. Neither is persisted, so
-    // there is no need to rewrite the config on fetch completion.
-    for (GitRepository& repo : repositories) {
-        if (repo.name == repoName) {
-            repo.status = success ? "Success" : "Error";
-            if (success) {
-                repo.lastFetch = QDateTime::currentDateTime().toString(Qt::ISODate);
-            }
-            repositoryModel->updateRepositoryStatus(repoName);
-            // The fetch just updated the remote-tracking refs, so the standing
-            // ahead/behind counts are stale (and would also be stale after an
-            // external rebase of the local branch). Recompute them now.
-            calculateCommitCountsAsync(repo);
-            break;
-        }
-    }
-}
-
-void FetchDeeznutzWindow::onBackgroundFetchError(const QString& repoName, const QString& errorMessage)
-{
-    logMessage(QString("✗ Error fetching %1: %2").arg(repoName, errorMessage));
-    
-    // In-memory status only; nothing persistable changed.
-    for (GitRepository& repo : repositories) {
-        if (repo.name == repoName) {
-            repo.status = "Error";
-            repositoryModel->updateRepositoryStatus(repoName);
-            break;
-        }
-    }
-}
-
-void FetchDeeznutzWindow::onCommitCountsUpdated(const QString& repoName, const QString& remoteName, int commitsAhead, int commitsBehind)
-{
-    // Find the repository and update the remote's commit counts
-    for (GitRepository& repo : repositories) {
-        if (repo.name == repoName) {
-            for (GitRemote& remote : repo.remotes) {
-                if (remote.name == remoteName) {
-                    remote.commitsAhead = commitsAhead;
-                    remote.commitsBehind = commitsBehind;
-                    repositoryModel->updateRemoteCounts(repoName, remoteName);
-                    break;
-                }
-            }
-            break;
-        }
+        trayIcon->showMessage(title, tags.join(", "), QSystemTrayIcon::Information, 24 * 60 * 60 * 1000);
     }
 }
 
@@ -794,21 +693,23 @@ void FetchDeeznutzWindow::closeEvent(QCloseEvent *event)
 void FetchDeeznutzWindow::updateRepositoryTree()
 {
     // Remember the selected repository so we can restore it after the rebuild.
-    QString selectedName, selectedPath;
+    RepositoryId selectedId = 0;
     if (GitRepository* selected = repositoryForIndex(repositoryView->currentIndex())) {
-        selectedName = selected->name;
-        selectedPath = selected->localPath;
+        selectedId = selected->id;
     }
     const int scrollValue = repositoryView->verticalScrollBar()->value();
 
-    repositoryModel->rebuild();
-    repositoryView->expandAll();
+    // Gives new repositories their ids and keeps the filesystem watcher's
+    // targets and the fetch schedule in sync with the tracked set.
+    core->syncRepositories();
 
-    // Keep the filesystem watcher's targets in sync with the tracked set.
-    repoWatcher->setRepositories(repositories);
+    repositoryModel->rebuild();
+    // Directories open, repositories closed: a repository's remote rows are
+    // only created once it is expanded.
+    repositoryView->expandToDepth(0);
 
-    if (!selectedName.isEmpty()) {
-        const QModelIndex restored = repositoryModel->indexForRepository(selectedName, selectedPath);
+    if (selectedId != 0) {
+        const QModelIndex restored = repositoryModel->indexForRepository(selectedId);
         if (restored.isValid()) {
             repositoryView->setCurrentIndex(restored);
         }
@@ -816,189 +717,194 @@ void FetchDeeznutzWindow::updateRepositoryTree()
     repositoryView->verticalScrollBar()->setValue(scrollValue);
 }
 
-void FetchDeeznutzWindow::startScheduledFetch()
+void FetchDeeznutzWindow::onParallelFetchesChanged()
 {
-    fetchTimer->setInterval(globalIntervalSpinBox->value() * 60000);
-    fetchTimer->start();
+    core->setMaxConcurrentFetches(parallelFetchesSpinBox->value());
 }
 
-void FetchDeeznutzWindow::stopScheduledFetch()
+void FetchDeeznutzWindow::onHostLimitChanged()
 {
-    fetchTimer->stop();
+    core->setHostLimit(hostLimitSpinBox->value());
 }
 
-void FetchDeeznutzWindow::fetchRepository(GitRepository& repo)
-{
-    // This method is kept for compatibility but now uses the background worker
-    if (!fetchWorker) {
-        logMessage("Error: Fetch worker is not initialized");
-        return;
-    }
-    
-    GitRepository repoCopy = repo;
-    QMetaObject::invokeMethod(fetchWorker, "fetchRepository", Qt::QueuedConnection, Q_ARG(GitRepository, repoCopy));
-}
-
-void FetchDeeznutzWindow::calculateCommitCounts(GitRepository& repo)
+void FetchDeeznutzWindow::scanDirectoryForRepositories(const QString& directoryPath)
 {
-    if (!GitUtils::isRepositoryValid(repo.localPath)) {
-        return;
-    }
+    QStringList excludeDirs = {".git", "node_modules", ".vscode", ".idea", "build", "dist", "target", "__pycache__"};
 
-    for (GitRemote& remote : repo.remotes) {
-        GitUtils::calculateRemoteCommitCounts(repo.localPath, remote, repo.branch, repo.name);
+    m_scanKnownPaths.clear();
+    for (const GitRepository& repo : core->repositories()) {
+        m_scanKnownPaths.insert(repo.localPath);
     }
+    m_scanNeedsReview.clear();
+    m_scanAdded = 0;
+    m_scanSkipped = 0;
+    m_scanWalkDone = false;
+    addDirectoryButton->setText("Cancel Scan");
 
-    updateRepositoryTree();
+    // The walk and the per-repository probing run on thread pools; results
+    // stream back in batches.
+    repoScanner->start(directoryPath, excludeDirs);
 }
 
-void FetchDeeznutzWindow::calculateCommitCountsAsync(const GitRepository& repo)
+void FetchDeeznutzWindow::onScanRepositoriesFound(const QStringList& paths)
 {
-    // Capture an immutable snapshot of everything the background thread needs.
-    // The worker never touches the shared `repositories` list; it computes into
-    // local copies and posts the results back to the main thread, which owns the
-    // list. This avoids data races and dangling pointers if the list is mutated
-    // (add/remove/scan) while the calculation is running.
-    const QString repoName = repo.name;
-    const QString repoPath = repo.localPath;
-    const QString branch = repo.branch;
-
-    QStringList remoteNames;
-    remoteNames.reserve(repo.remotes.size());
-    for (const GitRemote& remote : repo.remotes) {
-        remoteNames.append(remote.name);
+    QStringList fresh;
+    for (const QString& repoPath : paths) {
+        // Check if repository already exists
+        if (m_scanKnownPaths.contains(repoPath)) {
+            m_scanSkipped++;
+            continue;
+        }
+        m_scanKnownPaths.insert(repoPath);
+        fresh.append(repoPath);
     }
+    repoOnboarder->probe(fresh);
+}
 
-    [[maybe_unused]] QFuture<void> future = QtConcurrent::run([this, repoName, repoPath, branch, remoteNames]() {
-        if (!GitUtils::isRepositoryValid(repoPath)) {
-            return;
-        }
+void FetchDeeznutzWindow::onScanFinished(int repositoryCount, int directoryCount, bool cancelled)
+{
+    m_scanWalkDone = true;
+    m_scanCancelled = cancelled;
+    m_scanDirectoryCount = directoryCount;
+    Q_UNUSED(repositoryCount);
+    addDirectoryButton->setText("Add Directory");
+    finishScanIfIdle();
+}
 
-        for (const QString& remoteName : remoteNames) {
-            GitRemote remote;
-            remote.name = remoteName;
-            GitUtils::calculateRemoteCommitCounts(repoPath, remote, branch, repoName);
-
-            const int ahead = remote.commitsAhead;
-            const int behind = remote.commitsBehind;
-            // Deliver results to the main thread, which owns `repositories`.
-            QMetaObject::invokeMethod(this, [this, repoName, remoteName, ahead, behind]() {
-                onCommitCountsUpdated(repoName, remoteName, ahead, behind);
-            }, Qt::QueuedConnection);
+void FetchDeeznutzWindow::onRepositoriesProbed(const QList<GitRepository>& probed)
+{
+    QList<GitRepository> added;
+    for (const GitRepository& repo : probed) {
+        if (repo.name.isEmpty() || repo.remotes.isEmpty()) {
+            logMessage(LogLevel::Warning, QString("Skipped invalid repository at: %1 (no remotes found)").arg(repo.localPath));
+        } else if (repo.remotes.size() > 1) {
+            // Remote choices are made for all of them at once when the scan ends.
+            m_scanNeedsReview.append(repo);
+        } else {
+            added.append(repo);
         }
-    });
+    }
+    addScannedRepositories(added);
 }
 
-void FetchDeeznutzWindow::scanDirectoryForRepositories(const QString& directoryPath)
+void FetchDeeznutzWindow::addScannedRepositories(const QList<GitRepository>& added)
 {
-    QStringList excludeDirs = {".git", "node_modules", ".vscode", ".idea", "build", "dist", "target", "__pycache__"};
-    QStringList gitRepos = GitUtils::findGitRepositories(directoryPath, excludeDirs);
-
-    int addedCount = 0;
-    int skippedCount = 0;
+    if (added.isEmpty()) {
+        return;
+    }
 
-    for (const QString& repoPath : gitRepos) {
-        // Check if repository already exists
-        bool alreadyExists = false;
-        for (const GitRepository& existingRepo : repositories) {
-            if (existingRepo.localPath == repoPath) {
-                alreadyExists = true;
-                break;
-            }
-        }
+    for (const GitRepository& repo : added) {
+        core->repositories().append(repo);
+        QString worktreeInfo = repo.worktrees.isEmpty() ? "" : QString(" and %1 worktrees").arg(repo.worktrees.size());
+        logMessage(LogLevel::Info, QString("Discovered repository: %1 at %2 with %3 remotes%4").arg(repo.name, repo.localPath).arg(repo.remotes.size()).arg(worktreeInfo));
+    }
+    m_scanAdded += added.size();
+    core->syncRepositories(); // assigns the new repositories their ids
 
-        if (alreadyExists) {
-            skippedCount++;
-            continue;
-        }
+    // Show them and calculate their commit counts asynchronously
+    for (int i = core->repositories().size() - added.size(); i < core->repositories().size(); ++i) {
+        const GitRepository& repo = core->repositories().at(i);
+        revealRepository(repositoryModel->insertRepository(repo.id));
+        core->calculateCommitCountsAsync(repo);
+    }
+    core->saveRepositories();
+}
 
-        // Create new repository entry
-        GitRepository repo;
-        repo.name = GitUtils::getRepositoryName(repoPath);
-        repo.localPath = repoPath;
-        repo.branch = GitUtils::getRepositoryBranch(repoPath);
-        repo.fetchInterval = 60; // Default 1 hour
-        repo.enabled = true;
-        repo.status = "Ready";
-        repo.remotes = GitUtils::getRepositoryRemotes(repoPath);
-        repo.worktrees = GitUtils::findWorktreesForRepository(repoPath);
+void FetchDeeznutzWindow::finishScanIfIdle()
+{
+    if (!m_scanWalkDone || repoOnboarder->isBusy()) {
+        return;
+    }
+    m_scanWalkDone = false;
 
-        if (!repo.name.isEmpty() && !repo.remotes.isEmpty()) {
-            // If repository has multiple remotes, show selection dialog
-            if (repo.remotes.size() > 1) {
-                RemoteSelectionDialog remoteDialog(repo.remotes, this);
-                remoteDialog.setWindowTitle(QString("Select Remotes for %1").arg(repo.name));
-                if (remoteDialog.exec() == QDialog::Accepted) {
-                    QList<GitRemote> selectedRemotes = remoteDialog.getSelectedRemotes();
-                    if (!selectedRemotes.isEmpty()) {
-                        repo.remotes = selectedRemotes;
-                    } else {
-                        logMessage(QString("Skipped repository %1: no remotes selected").arg(repo.name));
-                        continue;
-                    }
-                } else {
-                    logMessage(QString("Skipped repository %1: user cancelled remote selection").arg(repo.name));
-                    continue;
-                }
+    if (!m_scanNeedsReview.isEmpty()) {
+        const QList<GitRepository> review = m_scanNeedsReview;
+        m_scanNeedsReview.clear();
+        RemoteReviewDialog reviewDialog(review, this);
+        if (reviewDialog.exec() == QDialog::Accepted) {
+            const QList<GitRepository> selected = reviewDialog.getSelectedRepositories();
+            if (selected.size() < review.size()) {
+                logMessage(LogLevel::Warning, QString("Skipped %1 repositories: no remotes selected").arg(review.size() - selected.size()));
             }
-            
-            repositories.append(repo);
-            addedCount++;
-            QString worktreeInfo = repo.worktrees.isEmpty() ? "" : QString(" and %1 worktrees").arg(repo.worktrees.size());
-            logMessage(QString("Discovered repository: %1 at %2 with %3 remotes%4").arg(repo.name, repoPath).arg(repo.remotes.size()).arg(worktreeInfo));
+            addScannedRepositories(selected);
         } else {
-            logMessage(QString("Skipped invalid repository at: %1 (no remotes found)").arg(repoPath));
+            logMessage(LogLevel::Warning, QString("Skipped %1 repositories: user cancelled remote selection").arg(review.size()));
         }
     }
 
-    if (addedCount > 0) {
-        // Calculate commit counts for newly added repositories asynchronously
-        for (int i = repositories.size() - addedCount; i < repositories.size(); ++i) {
-            calculateCommitCountsAsync(repositories[i]);
-        }
-        updateRepositoryTree();
-        saveRepositories();
-    }
-
-    logMessage(QString("Directory scan complete: %1 repositories added, %2 skipped (already exist)").arg(addedCount).arg(skippedCount));
+    logMessage(LogLevel::Info, QString("Directory scan %1: %2 repositories added, %3 skipped (already exist), %4 directories searched")
+                                   .arg(m_scanCancelled ? "cancelled" : "complete")
+                                   .arg(m_scanAdded).arg(m_scanSkipped).arg(m_scanDirectoryCount));
 }
 
 GitRepository* FetchDeeznutzWindow::repositoryForIndex(const QModelIndex& index)
 {
-    const int repoIndex = repositoryModel->repositoryIndex(index);
-    if (repoIndex < 0 || repoIndex >= repositories.size()) {
-        return nullptr;
+    const RepositoryId repoId = repositoryModel->repositoryId(index);
+    return repoId != 0 ? core->repository(repoId) : nullptr;
+}
+
+void FetchDeeznutzWindow::revealRepository(const QModelIndex& index)
+{
+    if (index.isValid()) {
+        repositoryView->expand(index.parent());
+    }
+}
+
+void FetchDeeznutzWindow::logMessage(LogLevel level, const QString& message)
+{
+    // Follow new messages only while scrolled to the end, so reading back
+    // through the log isn't interrupted.
+    const QScrollBar *bar = logView->verticalScrollBar();
+    const bool atEnd = bar->value() == bar->maximum();
+    logModel->append(level, message);
+    if (atEnd) {
+        logView->scrollToBottom();
     }
-    return &repositories[repoIndex];
 }
 
-void FetchDeeznutzWindow::logMessage(const QString& message)
+void FetchDeeznutzWindow::onLogFilterChanged()
 {
-    QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
-    logTextEdit->append(QString("[%1] %2").arg(timestamp, message));
+    logFilter->setMinimumLevel(static_cast<ActivityLogModel::Level>(logLevelComboBox->currentIndex()));
+    logFilter->setText(logFilterEdit->text().trimmed());
+    if (logFilter->isActive()) {
+        if (!logFilter->sourceModel()) {
+            logFilter->setSourceModel(logModel);
+            logView->setModel(logFilter);
+        }
+    } else if (logFilter->sourceModel()) {
+        // Unfiltered, the view reads the ring directly and appends stay O(1).
+        logView->setModel(logModel);
+        logFilter->setSourceModel(nullptr);
+    }
+    logView->scrollToBottom();
 }
 
 void FetchDeeznutzWindow::loadSettings()
 {
     QSettings settings;
-    
-    // Load global interval (default: 60 minutes)
-    int interval = settings.value("globalInterval", 60).toInt();
-    globalIntervalSpinBox->setValue(interval);
-    
-    // Load fetch timeout (default: 300 seconds = 5 minutes)
-    int fetchTimeout = settings.value("fetchTimeout", 300).toInt();
-    fetchTimeoutSpinBox->setValue(fetchTimeout);
-    QMetaObject::invokeMethod(fetchWorker, "setTimeout", Qt::QueuedConnection, Q_ARG(int, fetchTimeout));
-    
-    // Load connection timeout (default: 5 seconds)
-    int connectionTimeout = settings.value("connectionTimeout", 5).toInt();
-    connectionTimeoutSpinBox->setValue(connectionTimeout);
-    QMetaObject::invokeMethod(fetchWorker, "setConnectionTimeout", Qt::QueuedConnection, Q_ARG(int, connectionTimeout));
-    
-    // Load auto-fetch enabled state (default: true)
-    bool autoFetch = settings.value("autoFetchEnabled", true).toBool();
-    autoFetchCheckBox->setChecked(autoFetch);
+
+    // The fetch settings were loaded by the core; show them without feeding
+    // them back through the change handlers.
+    const QSignalBlocker blockInterval(globalIntervalSpinBox);
+    const QSignalBlocker blockJitter(jitterSpinBox);
+    const QSignalBlocker blockFetchTimeout(fetchTimeoutSpinBox);
+    const QSignalBlocker blockConnectionTimeout(connectionTimeoutSpinBox);
+    const QSignalBlocker blockParallel(parallelFetchesSpinBox);
+    const QSignalBlocker blockHostLimit(hostLimitSpinBox);
+    const QSignalBlocker blockAutoFetch(autoFetchCheckBox);
+    const QSignalBlocker blockStartMinimized(startMinimizedCheckBox);
+    const QSignalBlocker blockPersistCounts(persistCountsCheckBox);
+    const QSignalBlocker blockProbe(probeBeforeFetchCheckBox);
+
+    globalIntervalSpinBox->setValue(core->minimumInterval());
+    jitterSpinBox->setValue(core->jitterPercent());
+    fetchTimeoutSpinBox->setValue(core->fetchTimeout());
+    connectionTimeoutSpinBox->setValue(core->connectionTimeout());
+    parallelFetchesSpinBox->setValue(core->maxConcurrentFetches());
+    hostLimitSpinBox->setValue(core->hostLimit());
+    autoFetchCheckBox->setChecked(core->autoFetch());
+    persistCountsCheckBox->setChecked(core->persistCommitCounts());
+    probeBeforeFetchCheckBox->setChecked(core->probeBeforeFetch());
 
     // Load start-minimized preference (default: false -> show the window on launch)
     startMinimizedCheckBox->setChecked(settings.value("startMinimized", false).toBool());
@@ -1024,12 +930,10 @@ void FetchDeeznutzWindow::loadSettings()
 
 void FetchDeeznutzWindow::saveSettings()
 {
+    // Fetch settings are persisted by the core as they change; only the
+    // window's own state is written here.
     QSettings settings;
-    
-    settings.setValue("globalInterval", globalIntervalSpinBox->value());
-    settings.setValue("fetchTimeout", fetchTimeoutSpinBox->value());
-    settings.setValue("connectionTimeout", connectionTimeoutSpinBox->value());
-    settings.setValue("autoFetchEnabled", autoFetchCheckBox->isChecked());
+
     settings.setValue("startMinimized", startMinimizedCheckBox->isChecked());
     // Prefer the live geometry when the window is mapped; otherwise persist the
     // last stashed value.
@@ -1049,32 +953,12 @@ void FetchDeeznutzWindow::updateAutoFetchControls()
 {
     bool autoFetchEnabled = autoFetchCheckBox->isChecked();
     globalIntervalSpinBox->setEnabled(autoFetchEnabled);
+    jitterSpinBox->setEnabled(autoFetchEnabled);
     fetchTimeoutSpinBox->setEnabled(autoFetchEnabled);
     connectionTimeoutSpinBox->setEnabled(autoFetchEnabled);
 }
 
-void FetchDeeznutzWindow::loadRepositories()
+void FetchDeeznutzWindow::onPersistCountsToggled()
 {
-    RepositoryStore::LoadResult result = m_store.load();
-    for (const QString& message : result.messages) {
-        logMessage(message);
-    }
-
-    repositories = result.repositories;
-
-    // Calculate commit counts for loaded repositories asynchronously
-    for (const GitRepository& repo : repositories) {
-        calculateCommitCountsAsync(repo);
-    }
-}
-
-void FetchDeeznutzWindow::saveRepositories()
-{
-    QString error;
-    if (m_store.save(repositories, &error)) {
-        logMessage("Configuration saved");
-    } else {
-        logMessage(QString("Failed to save configuration: %1").arg(error));
-    }
+    core->setPersistCommitCounts(persistCountsCheckBox->isChecked());
 }
-
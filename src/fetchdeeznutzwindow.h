@@ -1,14 +1,16 @@
 #ifndef FETCHDEEZNUTZWINDOW_H
 #define FETCHDEEZNUTZWINDOW_H
 
+#include "activitylogmodel.h"
+#include "fetchcore.h"
 #include "gitmodels.h"
-#include "gitfetchworker.h"
 #include "gitutils.h"
+#include "remotereviewdialog.h"
 #include "remoteselectiondialog.h"
 #include "repositorydialog.h"
-#include "repositorystore.h"
+#include "repositoryonboarder.h"
 #include "repositorytreemodel.h"
-#include "repowatcher.h"
+#include "repositoryscanner.h"
 
 #include <QMainWindow>
 #include <QTreeView>
@@ -21,7 +23,9 @@
 #include <QLabel>
 #include <QSpinBox>
 #include <QCheckBox>
-#include <QTextEdit>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QListView>
 #include <QTimer>
 #include <QThread>
 #include <QProgressBar>
@@ -40,6 +44,7 @@
 #include <QFormLayout>
 #include <QSettings>
 #include <QByteArray>
+#include <QSet>
 
 class FetchDeeznutzWindow : public QMainWindow
 {
@@ -62,20 +67,28 @@ private slots:
     void onFetchIntervalChanged();
     void onFetchTimeoutChanged();
     void onConnectionTimeoutChanged();
+    void onParallelFetchesChanged();
+    void onHostLimitChanged();
+    void onJitterChanged();
     void onAutoFetchToggled();
-    void performScheduledFetch();
-    void onBackgroundFetchStarted(const QString& repoName);
-    void onBackgroundFetchProgress(const QString& repoName, const QString& remoteName, int progress);
-    void onRemoteStatusChanged(const QString& repoName, const QString& remoteName, const QString& status);
-    void onBackgroundFetchFinished(const QString& repoName, bool success, const QString& message);
-    void onBackgroundFetchError(const QString& repoName, const QString& errorMessage);
-    void onCommitCountsUpdated(const QString& repoName, const QString& remoteName, int commitsAhead, int commitsBehind);
+    // Starts the elapsed-time ticker when a remote begins fetching.
+    void onRemoteFetchStarted();
     // Shows a persistent tray notification when a fetch brings in new tags.
-    void onNewTagsFound(const QString& repoName, const QStringList& tags);
-    // Recomputes a repository's commit counts after an external git change.
-    void onExternalRepositoryChanged(const QString& repoName);
+    void onNewTagsFound(RepositoryId repoId, const QStringList& tags);
+    // Directory scan results, streamed from the background scanner.
+    void onScanRepositoriesFound(const QStringList& paths);
+    void onScanFinished(int repositoryCount, int directoryCount, bool cancelled);
+    void onRepositoriesProbed(const QList<GitRepository>& probed);
+    // Once the walk and every probe are done: remote review, then the summary.
+    void finishScanIfIdle();
     // Repaints in-flight remotes once per second so their elapsed counter ticks.
     void updateFetchElapsed();
+    void onPersistCountsToggled();
+    void onProbeBeforeFetchToggled();
+    // Applies the activity log's level and text filters.
+    void onLogFilterChanged();
+    // Shows how many fetches probe-first mode has skipped this session.
+    void onProbeSkipsChanged(int totalSkips);
     
     // System tray slots
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
@@ -87,18 +100,14 @@ private slots:
 private:
     void setupUI();
     void setupSystemTray();
-    void loadRepositories();
-    void saveRepositories();
-    void startScheduledFetch();
-    void stopScheduledFetch();
-    void fetchRepository(GitRepository& repo);
-    void logMessage(const QString& message);
-    void calculateCommitCounts(GitRepository& repo);
-    void calculateCommitCountsAsync(const GitRepository& repo);
+    void logMessage(LogLevel level, const QString& message);
     void scanDirectoryForRepositories(const QString& directoryPath);
-    // Full structural rebuild of the tree (after add/remove/scan/load), keeping
-    // the current selection where possible.
+    void addScannedRepositories(const QList<GitRepository>& added);
+    // Full structural rebuild of the tree (after loading), keeping the current
+    // selection where possible. Adds, edits and removals update it row by row.
     void updateRepositoryTree();
+    // Expands the directory of a repository entering the tree, like at load.
+    void revealRepository(const QModelIndex& index);
     // Resolves the repository backing a model index (repository or remote node).
     GitRepository* repositoryForIndex(const QModelIndex& index);
     void loadSettings();
@@ -130,6 +139,9 @@ private:
     QSpinBox *globalIntervalSpinBox;
     QSpinBox *fetchTimeoutSpinBox;
     QSpinBox *connectionTimeoutSpinBox;
+    QSpinBox *parallelFetchesSpinBox;
+    QSpinBox *hostLimitSpinBox;
+    QSpinBox *jitterSpinBox;
     
     // System tray
     QSystemTrayIcon *trayIcon;
@@ -139,22 +151,32 @@ private:
     QAction *quitAction;
     QCheckBox *autoFetchCheckBox;
     QCheckBox *startMinimizedCheckBox;
+    QCheckBox *persistCountsCheckBox;
+    QCheckBox *probeBeforeFetchCheckBox;
 
-    QTextEdit *logTextEdit;
+    QListView *logView;
+    ActivityLogModel *logModel;   // the most recent messages
+    ActivityLogFilter *logFilter; // attached only while a filter is set
+    QComboBox *logLevelComboBox;
+    QLineEdit *logFilterEdit;
 
-    // Background fetching
-    QThread *fetchThread;
-    GitFetchWorker *fetchWorker;
     QMap<QString, QProgressBar*> activeFetches;
     QGroupBox *fetchStatusGroup;
     QVBoxLayout *fetchStatusLayout;
+    QTimer *fetchTicker; // 1s heartbeat to animate elapsed time on active fetches
 
     // Data
-    RepositoryStore m_store;
-    RepoWatcher *repoWatcher;
-    QList<GitRepository> repositories;
-    QTimer *fetchTimer;
-    QTimer *fetchTicker; // 1s heartbeat to animate elapsed time on active fetches
+    FetchCore *core; // repositories, schedule and fetching; shared with the daemon
+    RepositoryScanner *repoScanner;
+    RepositoryOnboarder *repoOnboarder;
+    // "Add Directory" scan in progress
+    QSet<QString> m_scanKnownPaths; // localPaths already tracked or handled this scan
+    QList<GitRepository> m_scanNeedsReview; // multi-remote, awaiting remote selection
+    int m_scanAdded = 0;
+    int m_scanSkipped = 0;
+    int m_scanDirectoryCount = 0;
+    bool m_scanWalkDone = false;
+    bool m_scanCancelled = false;
     QByteArray m_geometry; // last known window geometry, persisted across sessions
 };
 
@@ -0,0 +1,130 @@
+#include "fetchjournal.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+constexpr int kFlushIntervalMs = 1000;
+constexpr qsizetype kFlushBytes = 64 * 1024;      // write early past this much
+constexpr qint64 kMaxFileBytes = 8 * 1024 * 1024; // rotate past this size
+constexpr int kKeepFiles = 5;                     // rotated generations kept
+} // namespace
+
+FetchJournal::FetchJournal(const QString& filePath, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_flushTimer(nullptr)
+{
+}
+
+FetchJournal::~FetchJournal()
+{
+    flush();
+}
+
+QString FetchJournal::defaultFilePath()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return QDir(dir).filePath(QStringLiteral("fetch-journal.jsonl"));
+}
+
+void FetchJournal::recordFetch(const RemoteFetchRecord& record)
+{
+    QJsonObject entry;
+    entry["type"] = QStringLiteral("fetch");
+    entry["repo"] = record.repoPath;
+    entry["remote"] = record.remoteName;
+    entry["url"] = record.url;
+    entry["start"] = double(record.startMs);
+    entry["end"] = double(record.endMs);
+    entry["durationMs"] = double(record.startMs > 0 ? record.endMs - record.startMs : 0);
+    if (record.bytes >= 0) {
+        entry["bytes"] = double(record.bytes);
+    }
+    entry["outcome"] = fetchStatusText(record.outcome);
+    entry["exitCode"] = record.exitCode;
+    append(entry);
+}
+
+void FetchJournal::recordNewTags(const QString& repoPath, qint64 timeMs, const QStringList& tags)
+{
+    QJsonObject entry;
+    entry["type"] = QStringLiteral("tags");
+    entry["repo"] = repoPath;
+    entry["time"] = double(timeMs);
+    entry["tags"] = QJsonArray::fromStringList(tags);
+    append(entry);
+}
+
+void FetchJournal::append(const QJsonObject& entry)
+{
+    m_buffer += QJsonDocument(entry).toJson(QJsonDocument::Compact);
+    m_buffer += '\n';
+
+    if (m_buffer.size() >= kFlushBytes) {
+        flush();
+        return;
+    }
+    if (!m_flushTimer) {
+        // Created here rather than in the constructor so it belongs to the
+        // thread the journal was moved to.
+        m_flushTimer = new QTimer(this);
+        m_flushTimer->setSingleShot(true);
+        m_flushTimer->setInterval(kFlushIntervalMs);
+        connect(m_flushTimer, &QTimer::timeout, this, &FetchJournal::flush);
+    }
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void FetchJournal::flush()
+{
+    if (m_flushTimer) {
+        m_flushTimer->stop();
+    }
+    if (m_buffer.isEmpty()) {
+        return;
+    }
+
+    if (m_fileSize < 0) {
+        QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+        m_fileSize = QFileInfo(m_filePath).size();
+    }
+    if (m_fileSize > 0 && m_fileSize + m_buffer.size() > kMaxFileBytes) {
+        rotate();
+    }
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(m_buffer) != m_buffer.size()) {
+        if (!m_failed) {
+            m_failed = true;
+            emit writeFailed(QString("%1: %2").arg(m_filePath, file.errorString()));
+        }
+        // Keep the lines for the next attempt, within reason.
+        if (m_buffer.size() > kMaxFileBytes) {
+            m_buffer.clear();
+        }
+        m_fileSize = -1;
+        return;
+    }
+    m_fileSize = file.size();
+    m_buffer.clear();
+    m_failed = false;
+}
+
+void FetchJournal::rotate()
+{
+    QFile::remove(QString("%1.%2").arg(m_filePath).arg(kKeepFiles));
+    for (int generation = kKeepFiles - 1; generation >= 1; --generation) {
+        QFile::rename(QString("%1.%2").arg(m_filePath).arg(generation),
+                      QString("%1.%2").arg(m_filePath).arg(generation + 1));
+    }
+    QFile::rename(m_filePath, m_filePath + QStringLiteral(".1"));
+    m_fileSize = 0;
+}
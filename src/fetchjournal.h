@@ -0,0 +1,68 @@
+#ifndef FETCHJOURNAL_H
+#define FETCHJOURNAL_H
+
+#include "gitfetchworker.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+
+/**
+ * Append-only history of fetch outcomes, for looking at fetch latency and
+ * failure trends over weeks. RuntimeState keeps only each remote's latest
+ * outcome; this is the full record.
+ *
+ * One JSON object per line (JSONL) in defaultFilePath():
+ *
+ *   {"type":"fetch","repo":"<path>","remote":"origin","url":"...",
+ *    "start":<epoch ms>,"end":<epoch ms>,"durationMs":1234,"bytes":5678,
+ *    "outcome":"Success","exitCode":0}
+ *   {"type":"tags","repo":"<path>","time":<epoch ms>,"tags":["v1.2.0"]}
+ *
+ * "bytes" is omitted when git reported none (nothing to receive, or a probe
+ * skipped the fetch), and "exitCode" is -1 when the process was killed.
+ *
+ * Meant to live on its own thread: records arrive as queued calls and are
+ * buffered, then written in one go at most once a second (sooner if the
+ * buffer grows large), so neither the GUI nor the fetch worker waits on the
+ * disk. Once the file passes a size limit it is rotated to "<file>.1", older
+ * generations moving up to "<file>.<kKeepFiles>" before being dropped.
+ */
+class FetchJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FetchJournal(const QString& filePath, QObject *parent = nullptr);
+    ~FetchJournal() override;
+
+    /** AppDataLocation/fetch-journal.jsonl */
+    static QString defaultFilePath();
+
+public slots:
+    void recordFetch(const RemoteFetchRecord& record);
+    void recordNewTags(const QString& repoPath, qint64 timeMs, const QStringList& tags);
+    // Writes whatever is buffered; also called on destruction.
+    void flush();
+
+signals:
+    // A write failed; reported once until writing works again.
+    void writeFailed(const QString& error);
+
+private:
+    void append(const QJsonObject& entry);
+    // Shifts <file> to <file>.1, <file>.1 to <file>.2, and so on.
+    void rotate();
+
+    QString m_filePath;
+    QByteArray m_buffer;  // complete lines not yet written
+    QTimer *m_flushTimer; // created on first use, on the journal's thread
+    qint64 m_fileSize = -1; // -1 until the file is first looked at
+    bool m_failed = false;
+};
+
+#endif // FETCHJOURNAL_H
@@ -0,0 +1,175 @@
+#include "fetchplanner.h"
+
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <algorithm>
+#include <climits>
+
+FetchPlanner::FetchPlanner(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &FetchPlanner::onTimeout);
+}
+
+void FetchPlanner::setRepositories(const QList<GitRepository>& repos)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash<RepositoryId, Tracked> previous = std::move(m_tracked);
+    m_tracked.clear();
+
+    for (const GitRepository& repo : repos) {
+        if (!repo.enabled || m_tracked.contains(repo.id)) {
+            continue;
+        }
+        const int interval = effectiveInterval(repo.fetchInterval);
+        const auto it = previous.find(repo.id);
+        if (it != previous.end()) {
+            Tracked tracked = it.value();
+            m_tracked.insert(repo.id, tracked);
+            if (tracked.intervalMinutes != interval) {
+                Tracked& updated = m_tracked[repo.id];
+                updated.intervalMinutes = interval;
+                schedule(repo.id, updated, nextDueMs(updated, now));
+            }
+            continue;
+        }
+
+        Tracked& tracked = m_tracked[repo.id];
+        tracked.intervalMinutes = interval;
+        const QDateTime lastFetch = QDateTime::fromString(repo.lastFetch, Qt::ISODate);
+        tracked.lastFetchMs = lastFetch.isValid() ? lastFetch.toMSecsSinceEpoch() : 0;
+        schedule(repo.id, tracked, nextDueMs(tracked, now));
+    }
+
+    // Only now that m_tracked is complete can stale slots be told apart from
+    // those of repositories not yet re-inserted; the rest go lazily in arm().
+    compactHeap();
+    arm();
+}
+
+void FetchPlanner::markFetched(RepositoryId repoId, qint64 whenMs)
+{
+    const auto it = m_tracked.find(repoId);
+    if (it == m_tracked.end()) {
+        return;
+    }
+    it->lastFetchMs = whenMs;
+    schedule(repoId, it.value(), nextDueMs(it.value(), QDateTime::currentMSecsSinceEpoch()));
+    compactHeap();
+    arm();
+}
+
+void FetchPlanner::setMinimumInterval(int minutes)
+{
+    m_minimumIntervalMinutes = qMax(1, minutes);
+}
+
+void FetchPlanner::setJitterPercent(int percent)
+{
+    m_jitterPercent = qBound(0, percent, 50);
+}
+
+void FetchPlanner::start()
+{
+    m_active = true;
+    arm();
+}
+
+void FetchPlanner::stop()
+{
+    m_active = false;
+    m_timer->stop();
+}
+
+int FetchPlanner::effectiveInterval(int repoIntervalMinutes) const
+{
+    return qMax(repoIntervalMinutes, m_minimumIntervalMinutes);
+}
+
+qint64 FetchPlanner::nextDueMs(const Tracked& tracked, qint64 nowMs) const
+{
+    const qint64 intervalMs = qint64(tracked.intervalMinutes) * 60000;
+    if (tracked.lastFetchMs > 0) {
+        // Uniform in [1 - j, 1 + j] of the interval.
+        const double jitter = m_jitterPercent / 100.0;
+        const double factor = 1.0 + jitter * (2.0 * QRandomGenerator::global()->generateDouble() - 1.0);
+        const qint64 dueMs = tracked.lastFetchMs + qint64(intervalMs * factor);
+        if (dueMs > nowMs) {
+            return dueMs;
+        }
+    }
+    // Never fetched or already overdue: spread over the startup window.
+    const qint64 spread = qMin<qint64>(kStartupSpreadMs, intervalMs);
+    return nowMs + qint64(QRandomGenerator::global()->bounded(double(spread)));
+}
+
+void FetchPlanner::schedule(RepositoryId repoId, Tracked& tracked, qint64 dueMs)
+{
+    tracked.generation = ++m_generation;
+    m_heap.push_back({dueMs, tracked.generation, repoId});
+    std::push_heap(m_heap.begin(), m_heap.end());
+}
+
+void FetchPlanner::compactHeap()
+{
+    // Superseded slots are normally dropped when they reach the top; compact
+    // if they pile up (e.g. many reschedules far in the future).
+    if (m_heap.size() > size_t(m_tracked.size()) * 2 + 16) {
+        m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), [this](const Slot& slot) {
+                         const auto it = m_tracked.constFind(slot.repoId);
+                         return it == m_tracked.constEnd() || it->generation != slot.generation;
+                     }), m_heap.end());
+        std::make_heap(m_heap.begin(), m_heap.end());
+    }
+}
+
+void FetchPlanner::arm()
+{
+    // Drop stale slots from the top so the timer targets a live entry.
+    while (!m_heap.empty()) {
+        const Slot& top = m_heap.front();
+        const auto it = m_tracked.constFind(top.repoId);
+        if (it != m_tracked.constEnd() && it->generation == top.generation) {
+            break;
+        }
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.pop_back();
+    }
+
+    if (!m_active || m_heap.empty()) {
+        m_timer->stop();
+        return;
+    }
+    const qint64 wait = m_heap.front().dueMs - QDateTime::currentMSecsSinceEpoch();
+    m_timer->start(int(qBound<qint64>(0, wait, INT_MAX)));
+}
+
+void FetchPlanner::onTimeout()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<RepositoryId> dueNow;
+    while (!m_heap.empty() && m_heap.front().dueMs <= now) {
+        const Slot slot = m_heap.front();
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.pop_back();
+
+        const auto it = m_tracked.find(slot.repoId);
+        if (it == m_tracked.end() || it->generation != slot.generation) {
+            continue; // stale
+        }
+        // Provisional next slot in case the fetch never reports back.
+        Tracked provisional = it.value();
+        provisional.lastFetchMs = now;
+        schedule(slot.repoId, it.value(), nextDueMs(provisional, now));
+        dueNow.append(slot.repoId);
+    }
+    compactHeap();
+    arm();
+
+    for (RepositoryId repoId : std::as_const(dueNow)) {
+        emit due(repoId);
+    }
+}
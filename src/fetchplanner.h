@@ -0,0 +1,89 @@
+#ifndef FETCHPLANNER_H
+#define FETCHPLANNER_H
+
+#include "gitmodels.h"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <vector>
+
+class QTimer;
+
+/**
+ * Decides when each repository is due for a background fetch. Every enabled
+ * repository gets its own due time (last fetch + its interval, randomly
+ * stretched or shortened by the jitter percentage) and the planner wakes up
+ * for the earliest one only, via a min-heap and a single-shot timer, so fetches
+ * are spread over the interval instead of arriving as one wave.
+ *
+ * Repositories that have never been fetched (or are overdue) are spread over
+ * the first kStartupSpreadMs after being added. The interval used is the
+ * repository's own fetchInterval, but never less than minimumInterval().
+ *
+ * After emitting due() the repository is provisionally rescheduled a full
+ * interval later; markFetched() then re-bases it on the actual completion time.
+ */
+class FetchPlanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kStartupSpreadMs = 30000;
+
+    explicit FetchPlanner(QObject *parent = nullptr);
+
+    /** Sync the tracked set (enabled repositories) and their intervals. */
+    void setRepositories(const QList<GitRepository>& repos);
+    /** Record a finished fetch attempt; the next one is one interval later. */
+    void markFetched(RepositoryId repoId, qint64 whenMs);
+
+    /** Floor for every repository's interval; applied on the next setRepositories(). */
+    void setMinimumInterval(int minutes);
+    void setJitterPercent(int percent);
+    int jitterPercent() const { return m_jitterPercent; }
+
+    /** Due repositories are only reported while started. */
+    void start();
+    void stop();
+    bool isActive() const { return m_active; }
+
+signals:
+    void due(RepositoryId repoId);
+
+private slots:
+    void onTimeout();
+
+private:
+    struct Tracked {
+        int intervalMinutes = 0; // effective interval (already clamped)
+        qint64 lastFetchMs = 0;  // 0 = never fetched
+        quint64 generation = 0;  // slot currently in force; other heap slots are stale
+    };
+    struct Slot {
+        qint64 dueMs;
+        quint64 generation;
+        RepositoryId repoId;
+        // std heap functions build a max-heap; invert for earliest-first.
+        bool operator<(const Slot& other) const { return dueMs > other.dueMs; }
+    };
+
+    int effectiveInterval(int repoIntervalMinutes) const;
+    // Due time for a repository fetched at lastFetchMs (0 = never), jittered.
+    qint64 nextDueMs(const Tracked& tracked, qint64 nowMs) const;
+    void schedule(RepositoryId repoId, Tracked& tracked, qint64 dueMs);
+    // Drops superseded slots once they outnumber live ones. Only valid while
+    // m_tracked is complete, never midway through setRepositories().
+    void compactHeap();
+    void arm();
+
+    QHash<RepositoryId, Tracked> m_tracked;
+    std::vector<Slot> m_heap;
+    quint64 m_generation = 0; // global, so a removed-and-re-added repo can't revive old slots
+    QTimer *m_timer;
+    int m_minimumIntervalMinutes = 1;
+    int m_jitterPercent = 10;
+    bool m_active = false;
+};
+
+#endif // FETCHPLANNER_H
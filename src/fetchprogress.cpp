@@ -0,0 +1,123 @@
+#include "fetchprogress.h"
+
+#include <QList>
+#include <QRegularExpression>
+
+namespace {
+double unitMultiplier(const QString& unit)
+{
+    if (unit == QStringLiteral("KiB")) {
+        return 1024.0;
+    }
+    if (unit == QStringLiteral("MiB")) {
+        return 1024.0 * 1024.0;
+    }
+    if (unit == QStringLiteral("GiB")) {
+        return 1024.0 * 1024.0 * 1024.0;
+    }
+    return 1.0; // "bytes"
+}
+} // namespace
+
+QString FetchProgress::formatBytes(double bytes)
+{
+    if (bytes >= 1024.0 * 1024.0 * 1024.0) {
+        return QStringLiteral("%1 GiB").arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+    }
+    if (bytes >= 1024.0 * 1024.0) {
+        return QStringLiteral("%1 MiB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024.0) {
+        return QStringLiteral("%1 KiB").arg(bytes / 1024.0, 0, 'f', 0);
+    }
+    return QStringLiteral("%1 bytes").arg(qint64(bytes));
+}
+
+QString FetchProgress::summary() const
+{
+    QString text = phase;
+    if (percent >= 0) {
+        text += QStringLiteral(" %1%").arg(percent);
+    } else if (current >= 0) {
+        text += QStringLiteral(" %1").arg(current);
+    }
+    if (bytes >= 0) {
+        text += QStringLiteral(", ") + formatBytes(double(bytes));
+    }
+    if (bytesPerSecond >= 0 && !done) {
+        text += QStringLiteral(", %1/s").arg(formatBytes(bytesPerSecond));
+    }
+    return text;
+}
+
+bool FetchProgressParser::parseLine(const QString& line, FetchProgress& progress)
+{
+    // <phase>: <pct>% (<cur>/<total>)[, <bytes> <unit>[ | <rate> <unit>/s]][, done.]
+    static const QRegularExpression percentRe(QStringLiteral(
+        R"(^([A-Za-z][A-Za-z ]*):\s+(\d+)%\s+\((\d+)/(\d+)\)(?:,\s+([\d.]+)\s+(bytes|KiB|MiB|GiB)(?:\s+\|\s+([\d.]+)\s+(bytes|KiB|MiB|GiB)/s)?)?(,\s+done\.?)?)"));
+    // <phase>: <count>[, done.]   (e.g. "Enumerating objects: 20, done.")
+    static const QRegularExpression countRe(QStringLiteral(
+        R"(^([A-Za-z][A-Za-z ]*):\s+(\d+)(,\s+done\.?)?$)"));
+
+    QString text = line.trimmed();
+    FetchProgress parsed;
+    if (text.startsWith(QStringLiteral("remote:"))) {
+        parsed.fromRemote = true;
+        text = text.mid(7).trimmed();
+    }
+
+    QRegularExpressionMatch m = percentRe.match(text);
+    if (m.hasMatch()) {
+        parsed.phase = m.captured(1).trimmed();
+        parsed.percent = m.captured(2).toInt();
+        parsed.current = m.captured(3).toLongLong();
+        parsed.total = m.captured(4).toLongLong();
+        if (m.capturedLength(5) > 0) {
+            parsed.bytes = qint64(m.captured(5).toDouble() * unitMultiplier(m.captured(6)));
+        }
+        if (m.capturedLength(7) > 0) {
+            parsed.bytesPerSecond = m.captured(7).toDouble() * unitMultiplier(m.captured(8));
+        }
+        parsed.done = m.capturedLength(9) > 0;
+        progress = parsed;
+        return true;
+    }
+
+    m = countRe.match(text);
+    if (m.hasMatch()) {
+        parsed.phase = m.captured(1).trimmed();
+        parsed.current = m.captured(2).toLongLong();
+        parsed.done = m.capturedLength(3) > 0;
+        progress = parsed;
+        return true;
+    }
+    return false;
+}
+
+QList<FetchProgress> FetchProgressParser::feed(const QByteArray& chunk)
+{
+    QList<FetchProgress> reports;
+    m_partial += chunk;
+
+    int start = 0;
+    for (int i = 0; i < m_partial.size(); ++i) {
+        const char c = m_partial.at(i);
+        if (c != '\r' && c != '\n') {
+            continue;
+        }
+        if (i > start) {
+            FetchProgress progress;
+            if (parseLine(QString::fromUtf8(m_partial.constData() + start, i - start), progress)) {
+                reports.append(progress);
+            }
+        }
+        start = i + 1;
+    }
+    m_partial.remove(0, start);
+
+    // A line without a terminator this long isn't progress; don't buffer it forever.
+    if (m_partial.size() > 4096) {
+        m_partial.clear();
+    }
+    return reports;
+}
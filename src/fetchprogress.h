@@ -0,0 +1,54 @@
+#ifndef FETCHPROGRESS_H
+#define FETCHPROGRESS_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+
+/**
+ * One progress report from `git fetch --progress`, e.g.
+ *
+ *   remote: Counting objects:  66% (2/3)
+ *   Receiving objects:  45% (9/20), 1.20 MiB | 600.00 KiB/s
+ *   Resolving deltas: 100% (3/3), done.
+ *
+ * Fields git didn't report are left at -1.
+ */
+struct FetchProgress {
+    QString phase;          // "Counting objects", "Receiving objects", ...
+    bool fromRemote = false; // phase ran on the server ("remote: " prefix)
+    int percent = -1;
+    qint64 current = -1;
+    qint64 total = -1;
+    qint64 bytes = -1;          // transferred so far (Receiving objects only)
+    double bytesPerSecond = -1; // git's current throughput estimate
+    bool done = false;
+
+    /** Short human-readable form, e.g. "Receiving objects 45%, 1.2 MiB, 600 KiB/s". */
+    QString summary() const;
+
+    /** Format a byte count the way git does (bytes, KiB, MiB, GiB). */
+    static QString formatBytes(double bytes);
+};
+
+Q_DECLARE_METATYPE(FetchProgress)
+
+/**
+ * Incremental parser for git's progress output. git redraws a progress line in
+ * place with '\r' and ends a phase with '\n'; feed() accepts arbitrary chunks
+ * of the (stderr) stream and returns a report for every complete line that
+ * looks like progress.
+ */
+class FetchProgressParser
+{
+public:
+    QList<FetchProgress> feed(const QByteArray& chunk);
+
+    /** Parse a single line; returns false if it isn't a progress line. */
+    static bool parseLine(const QString& line, FetchProgress& progress);
+
+private:
+    QByteArray m_partial; // bytes after the last line terminator
+};
+
+#endif // FETCHPROGRESS_H
@@ -0,0 +1,195 @@
+#include "fetchscheduler.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+constexpr int kDefaultHostLimit = 4;
+} // namespace
+
+FetchScheduler::FetchScheduler(QObject *parent)
+    : QObject(parent)
+    , m_hostLimit(kDefaultHostLimit)
+    // Matches the worker's default in-flight limit.
+    , m_globalLimit(qMax(4, QThread::idealThreadCount() * 2))
+{
+}
+
+QString FetchScheduler::hostForUrl(const QString& url)
+{
+    const QString trimmed = url.trimmed();
+    if (trimmed.contains(QStringLiteral("://"))) {
+        const QUrl parsed(trimmed);
+        if (parsed.isLocalFile() || parsed.host().isEmpty()) {
+            return QStringLiteral("local");
+        }
+        const QString host = parsed.host().toLower();
+        return parsed.port() > 0 ? QStringLiteral("%1:%2").arg(host).arg(parsed.port()) : host;
+    }
+
+    // scp-like syntax: [user@]host:path. git treats it as a local path if a
+    // slash comes before the first colon.
+    const int colon = trimmed.indexOf(QLatin1Char(':'));
+    const int slash = trimmed.indexOf(QLatin1Char('/'));
+    if (colon > 0 && (slash < 0 || colon < slash)) {
+        QString host = trimmed.left(colon);
+        const int at = host.lastIndexOf(QLatin1Char('@'));
+        if (at >= 0) {
+            host = host.mid(at + 1);
+        }
+        return host.toLower();
+    }
+    return QStringLiteral("local");
+}
+
+bool FetchScheduler::enqueue(const GitRepository& repo, Priority priority)
+{
+    if (m_inFlight.contains(repo.id)) {
+        return false;
+    }
+
+    for (Request& pending : m_pending) {
+        if (pending.repo.id == repo.id) {
+            pending.priority = std::max(pending.priority, priority);
+            describe(pending, repo); // pick up any edits made while it waited
+            pump();
+            return true;
+        }
+    }
+
+    Request request;
+    request.priority = priority;
+    request.sequence = m_sequence++;
+    describe(request, repo);
+    m_pending.append(request);
+    pump();
+    return true;
+}
+
+void FetchScheduler::describe(Request& request, const GitRepository& repo)
+{
+    request.repo = repo;
+    request.hostLoad.clear();
+    for (const GitRemote& remote : repo.remotes) {
+        ++request.hostLoad[hostForUrl(remote.url)];
+    }
+    request.primaryHost = repo.remotes.isEmpty() ? QString() : hostForUrl(repo.remotes.first().url);
+    const QDateTime lastFetch = QDateTime::fromString(repo.lastFetch, Qt::ISODate);
+    request.lastFetchMs = lastFetch.isValid() ? lastFetch.toMSecsSinceEpoch() : 0;
+}
+
+void FetchScheduler::clearPending()
+{
+    m_pending.clear();
+}
+
+void FetchScheduler::setHostLimit(int limit)
+{
+    m_hostLimit = qMax(1, limit);
+    pump();
+}
+
+void FetchScheduler::setGlobalLimit(int limit)
+{
+    m_globalLimit = qMax(1, limit);
+    pump();
+}
+
+void FetchScheduler::onFetchFinished(RepositoryId repoId)
+{
+    const auto it = m_inFlight.constFind(repoId);
+    if (it == m_inFlight.constEnd()) {
+        return;
+    }
+    for (auto host = it->constBegin(); host != it->constEnd(); ++host) {
+        m_remoteLoad -= host.value();
+        if ((m_hostLoad[host.key()] -= host.value()) <= 0) {
+            m_hostLoad.remove(host.key());
+        }
+    }
+    m_inFlight.erase(it);
+    pump();
+}
+
+bool FetchScheduler::fitsLimits(const Request& request) const
+{
+    const int remotes = request.repo.remotes.size();
+    if (m_remoteLoad > 0 && m_remoteLoad + remotes > m_globalLimit) {
+        return false;
+    }
+    for (auto it = request.hostLoad.constBegin(); it != request.hostLoad.constEnd(); ++it) {
+        const int load = m_hostLoad.value(it.key());
+        if (load > 0 && load + it.value() > m_hostLimit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int FetchScheduler::pickNext() const
+{
+    // Highest priority among the requests that can run right now.
+    int bestPriority = -1;
+    QStringList hosts; // primary hosts with a runnable request at that priority
+    for (const Request& request : m_pending) {
+        if (!fitsLimits(request)) {
+            continue;
+        }
+        const int priority = static_cast<int>(request.priority);
+        const QString& host = request.primaryHost;
+        if (priority > bestPriority) {
+            bestPriority = priority;
+            hosts = {host};
+        } else if (priority == bestPriority && !hosts.contains(host)) {
+            hosts.append(host);
+        }
+    }
+    if (bestPriority < 0) {
+        return -1;
+    }
+
+    // Round-robin: the next primary host after the one served last.
+    std::sort(hosts.begin(), hosts.end());
+    const auto next = std::upper_bound(hosts.cbegin(), hosts.cend(), m_lastHost);
+    const QString host = (next != hosts.cend()) ? *next : hosts.first();
+
+    // Stalest request for that host; enqueue order breaks ties.
+    int best = -1;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const Request& request = m_pending.at(i);
+        if (static_cast<int>(request.priority) != bestPriority || request.primaryHost != host
+            || !fitsLimits(request)) {
+            continue;
+        }
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+        const Request& current = m_pending.at(best);
+        if (request.lastFetchMs < current.lastFetchMs
+            || (request.lastFetchMs == current.lastFetchMs && request.sequence < current.sequence)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void FetchScheduler::pump()
+{
+    while (m_remoteLoad < m_globalLimit) {
+        const int index = pickNext();
+        if (index < 0) {
+            return;
+        }
+        const Request request = m_pending.takeAt(index);
+        m_lastHost = request.primaryHost;
+        for (auto it = request.hostLoad.constBegin(); it != request.hostLoad.constEnd(); ++it) {
+            m_hostLoad[it.key()] += it.value();
+            m_remoteLoad += it.value();
+        }
+        m_inFlight.insert(request.repo.id, request.hostLoad);
+        emit fetchDispatched(request.repo);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef FETCHSCHEDULER_H
+#define FETCHSCHEDULER_H
+
+#include "gitmodels.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+/**
+ * Admission control between the controller and GitFetchWorker. Fetch requests
+ * are queued here and handed to the worker (via fetchDispatched) only when
+ * there is room for them:
+ *
+ *  - at most hostLimit() remotes in flight per git host (the URL authority of
+ *    each remote), so one server isn't hit by dozens of parallel sessions. A
+ *    repository charges every host one slot per remote it fetches from there,
+ *    since each remote is its own session;
+ *  - at most globalLimit() remotes in flight overall, the same unit as the
+ *    worker's own limit, so nothing dispatched waits in the worker's queue
+ *    (where its timeout would already be running). A repository with more
+ *    remotes than a limit allows goes once nothing else holds that limit,
+ *    rather than never;
+ *  - manual requests before background ones, and within a priority the repo
+ *    fetched longest ago (never-fetched first);
+ *  - hosts are served round-robin, so a large batch for one server can't starve
+ *    the repositories living elsewhere.
+ *
+ * Requests are keyed by repository id (the key the worker reports back
+ * with). Re-queuing a pending repository only raises its priority. Lives on the
+ * GUI thread; the worker's fetchFinished/fetchError release the slots.
+ */
+class FetchScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority { Background = 0, Manual = 1 };
+
+    explicit FetchScheduler(QObject *parent = nullptr);
+
+    /**
+     * Queue a repository for fetching. Returns false if it's already in
+     * flight (pending requests are merged, keeping the higher priority).
+     */
+    bool enqueue(const GitRepository& repo, Priority priority);
+    /** Drop all pending requests; in-flight fetches are left to finish. */
+    void clearPending();
+
+    void setHostLimit(int limit);
+    int hostLimit() const { return m_hostLimit; }
+    void setGlobalLimit(int limit);
+    int globalLimit() const { return m_globalLimit; }
+
+    int pendingCount() const { return m_pending.size(); }
+    // Repositories in flight; inFlightRemotes() is what the limits count.
+    int inFlightCount() const { return m_inFlight.size(); }
+    int inFlightRemotes() const { return m_remoteLoad; }
+    bool isInFlight(RepositoryId repoId) const { return m_inFlight.contains(repoId); }
+
+    /**
+     * The host a remote URL talks to: the authority of scheme URLs, the part
+     * before ':' of scp-style "user@host:path", or "local" for paths and
+     * file:// URLs.
+     */
+    static QString hostForUrl(const QString& url);
+
+public slots:
+    // Wire to GitFetchWorker::fetchFinished / fetchError.
+    void onFetchFinished(RepositoryId repoId);
+
+signals:
+    void fetchDispatched(const GitRepository& repo);
+
+private:
+    struct Request {
+        GitRepository repo;
+        Priority priority = Priority::Background;
+        QString primaryHost;            // host of the first remote, for round-robin
+        QHash<QString, int> hostLoad;   // host -> remotes of this repository there
+        qint64 lastFetchMs = 0;         // 0 = never fetched
+        quint64 sequence = 0;           // enqueue order, for stable ties
+    };
+
+    // (Re)derive everything a request caches from the repository.
+    static void describe(Request& request, const GitRepository& repo);
+    bool fitsLimits(const Request& request) const;
+    // Index into m_pending of the next request to dispatch, or -1.
+    int pickNext() const;
+    void pump();
+
+    QList<Request> m_pending;
+    QHash<RepositoryId, QHash<QString, int>> m_inFlight; // repo id -> remotes it runs per host
+    QHash<QString, int> m_hostLoad;         // host -> remotes in flight
+    int m_remoteLoad = 0;                   // remotes in flight overall
+    QString m_lastHost;                     // primary host served last (round-robin cursor)
+    quint64 m_sequence = 0;
+    int m_hostLimit;
+    int m_globalLimit;
+};
+
+#endif // FETCHSCHEDULER_H
@@ -0,0 +1,154 @@
+#include "gitbatchpool.h"
+#include "gitutils.h"
+
+#include <QProcess>
+#include <QThreadStorage>
+
+namespace {
+constexpr int kMaxEntriesPerThread = 16;    // co-processes kept alive per thread
+constexpr qint64 kIdleEvictMs = 60 * 1000;  // close co-processes unused for this long
+constexpr int kStartTimeoutMs = 5000;
+constexpr int kReplyTimeoutMs = 10000;
+
+QThreadStorage<GitBatchPool*> g_pools;
+
+void closeProcess(QProcess* proc)
+{
+    if (!proc || proc->state() == QProcess::NotRunning) {
+        return;
+    }
+    // EOF on stdin makes cat-file exit cleanly; kill only if it lingers.
+    proc->closeWriteChannel();
+    if (!proc->waitForFinished(1000)) {
+        proc->kill();
+        proc->waitForFinished(1000);
+    }
+}
+} // namespace
+
+GitBatchPool::~GitBatchPool()
+{
+    for (const auto& entry : std::as_const(m_entries)) {
+        closeProcess(entry->catFile.get());
+    }
+}
+
+GitBatchPool& GitBatchPool::forCurrentThread()
+{
+    if (!g_pools.hasLocalData()) {
+        g_pools.setLocalData(new GitBatchPool());
+    }
+    return *g_pools.localData();
+}
+
+GitBatchPool::Entry& GitBatchPool::entryFor(const QString& repoPath)
+{
+    evictIdle(repoPath);
+    std::shared_ptr<Entry>& slot = m_entries[repoPath];
+    if (!slot) {
+        slot = std::make_shared<Entry>();
+    }
+    slot->lastUsed.start();
+    return *slot;
+}
+
+void GitBatchPool::evictIdle(const QString& keep)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it.key() != keep && it.value()->lastUsed.isValid()
+            && it.value()->lastUsed.elapsed() > kIdleEvictMs) {
+            closeProcess(it.value()->catFile.get());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Still over the cap: drop the least recently used entries.
+    while (m_entries.size() >= kMaxEntriesPerThread) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it.key() == keep) {
+                continue;
+            }
+            if (oldest == m_entries.end()
+                || it.value()->lastUsed.elapsed() > oldest.value()->lastUsed.elapsed()) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_entries.end()) {
+            break;
+        }
+        closeProcess(oldest.value()->catFile.get());
+        m_entries.erase(oldest);
+    }
+}
+
+bool GitBatchPool::ensureCatFile(const QString& repoPath, Entry& entry)
+{
+    if (entry.catFile && entry.catFile->state() == QProcess::Running) {
+        return true;
+    }
+
+    entry.catFile = std::make_unique<QProcess>();
+    entry.catFile->setProcessEnvironment(GitUtils::baseGitEnvironment());
+    // Unknown revisions come back as "<input> missing" on stdout; stderr is
+    // only used for hard errors, which we don't parse.
+    entry.catFile->setProcessChannelMode(QProcess::SeparateChannels);
+    entry.catFile->start(QStringLiteral("git"),
+                         {QStringLiteral("-C"), repoPath,
+                          QStringLiteral("cat-file"), QStringLiteral("--batch-check=%(objectname)")});
+    if (!entry.catFile->waitForStarted(kStartTimeoutMs)) {
+        entry.catFile.reset();
+        return false;
+    }
+    return true;
+}
+
+bool GitBatchPool::resolve(const QString& repoPath, const QStringList& revisions, QStringList& objectNames)
+{
+    objectNames.clear();
+    if (revisions.isEmpty()) {
+        return true;
+    }
+
+    Entry& entry = entryFor(repoPath);
+    if (!ensureCatFile(repoPath, entry)) {
+        return false;
+    }
+    QProcess* proc = entry.catFile.get();
+
+    // Pipeline every query, then collect one reply line per query. A revision
+    // containing a newline would desynchronize the stream, so refuse those.
+    QByteArray request;
+    for (const QString& rev : revisions) {
+        if (rev.contains(QLatin1Char('\n'))) {
+            return false;
+        }
+        request += rev.toUtf8();
+        request += '\n';
+    }
+    if (proc->write(request) != request.size()) {
+        closeProcess(proc);
+        entry.catFile.reset();
+        return false;
+    }
+
+    objectNames.reserve(revisions.size());
+    while (objectNames.size() < revisions.size()) {
+        if (!proc->canReadLine() && !proc->waitForReadyRead(kReplyTimeoutMs)) {
+            // Died or wedged: drop it so the next query starts a fresh one.
+            closeProcess(proc);
+            entry.catFile.reset();
+            objectNames.clear();
+            return false;
+        }
+        while (proc->canReadLine() && objectNames.size() < revisions.size()) {
+            const QString line = QString::fromUtf8(proc->readLine()).trimmed();
+            // Resolved objects print just the object name; anything else
+            // ("<rev> missing", "<rev> ambiguous") has a space in it.
+            objectNames.append(line.contains(QLatin1Char(' ')) ? QString() : line);
+        }
+    }
+    return true;
+}
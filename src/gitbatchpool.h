@@ -0,0 +1,57 @@
+#ifndef GITBATCHPOOL_H
+#define GITBATCHPOOL_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class QProcess;
+
+/**
+ * Pool of long-lived git co-processes, one per repository, used to answer ref
+ * lookups without paying process-startup cost on every query.
+ *
+ * Each repository gets a `git cat-file --batch-check` child that stays running
+ * and resolves revisions written to its stdin. Entries that sit idle are
+ * closed, and the pool is capped so a sweep over hundreds of repositories
+ * doesn't leave hundreds of processes behind.
+ *
+ * QProcess is bound to the thread that created it, so pools are per-thread:
+ * forCurrentThread() hands out the calling thread's pool, which is torn down
+ * (closing its children) when that thread exits. Pool threads used by
+ * QtConcurrent expire after a period of inactivity, which also evicts their
+ * co-processes.
+ */
+class GitBatchPool
+{
+public:
+    ~GitBatchPool();
+
+    /** The calling thread's pool (created on first use). */
+    static GitBatchPool& forCurrentThread();
+
+    /**
+     * Resolve each revision (e.g. "refs/heads/main", "HEAD") to a full object
+     * name. The result has one entry per input; unresolvable revisions map to an
+     * empty string. Returns false if the co-process could not be used at all, in
+     * which case the caller should fall back to spawning git.
+     */
+    bool resolve(const QString& repoPath, const QStringList& revisions, QStringList& objectNames);
+
+private:
+    struct Entry {
+        std::unique_ptr<QProcess> catFile;
+        QElapsedTimer lastUsed;
+    };
+
+    GitBatchPool() = default;
+    Entry& entryFor(const QString& repoPath);
+    bool ensureCatFile(const QString& repoPath, Entry& entry);
+    void evictIdle(const QString& keep);
+
+    QHash<QString, std::shared_ptr<Entry>> m_entries; // keyed by repository path
+};
+
+#endif // GITBATCHPOOL_H
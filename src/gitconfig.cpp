@@ -0,0 +1,617 @@
+#include "gitconfig.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <memory>
+
+namespace GitConfig {
+
+namespace {
+constexpr int kMaxIncludeDepth = 10; // same bound git uses
+
+// Parsed config file, shared between callers and revalidated on access.
+struct ParsedFile {
+    qint64 mtimeMs = -1;
+    qint64 size = -1;
+    QList<Entry> entries; // include directives are kept as ordinary entries
+};
+
+QMutex g_fileMutex;
+QHash<QString, std::shared_ptr<const ParsedFile>> g_fileCache; // keyed by file path
+
+bool isKeyChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+}
+
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// "[section]", "[section \"subsection\"]" or the deprecated "[section.subsection]",
+// with i just past the '['. Leaves i after the ']'.
+bool parseSectionHeader(const QByteArray& data, int& i, QString& section)
+{
+    const int n = data.size();
+    const int start = i;
+    while (i < n && (isKeyChar(data[i]) || data[i] == '.')) {
+        ++i;
+    }
+    const QByteArray name = data.mid(start, i - start);
+    if (name.isEmpty() || i >= n) {
+        return false;
+    }
+
+    if (data[i] == ']') {
+        ++i;
+        // The deprecated form's subsection is case-insensitive, so lower-cased.
+        const int dot = name.indexOf('.');
+        section = dot < 0 ? QString::fromLatin1(name).toLower()
+                          : QString::fromLatin1(name.left(dot)).toLower() + QLatin1Char('.')
+                                + QString::fromLatin1(name.mid(dot + 1)).toLower();
+        return true;
+    }
+    if (name.contains('.')) {
+        return false;
+    }
+
+    while (i < n && isBlank(data[i])) {
+        ++i;
+    }
+    if (i >= n || data[i] != '"') {
+        return false;
+    }
+    ++i;
+    QByteArray subsection;
+    while (i < n && data[i] != '"') {
+        if (data[i] == '\n') {
+            return false;
+        }
+        if (data[i] == '\\') {
+            ++i;
+            if (i >= n || data[i] == '\n') {
+                return false;
+            }
+        }
+        subsection.append(data[i]);
+        ++i;
+    }
+    if (i + 1 >= n || data[i + 1] != ']') {
+        return false;
+    }
+    i += 2;
+    section = QString::fromLatin1(name).toLower() + QLatin1Char('.') + QString::fromUtf8(subsection);
+    return true;
+}
+
+// Value after '=', with i just past it: quotes, escapes, continuation lines and
+// trailing comments are handled the way git does. Leaves i after the line.
+QString parseValue(const QByteArray& data, int& i)
+{
+    const int n = data.size();
+    QByteArray value;
+    bool quoted = false;
+    bool comment = false;
+    int pendingSpaces = 0; // whitespace kept only if more text follows
+
+    while (i < n) {
+        char c = data[i++];
+        if (c == '\n') {
+            break;
+        }
+        if (comment) {
+            continue;
+        }
+        if (!quoted && isBlank(c)) {
+            if (!value.isEmpty()) {
+                ++pendingSpaces;
+            }
+            continue;
+        }
+        if (!quoted && (c == '#' || c == ';')) {
+            comment = true;
+            continue;
+        }
+        for (; pendingSpaces > 0; --pendingSpaces) {
+            value.append(' ');
+        }
+        if (c == '"') {
+            quoted = !quoted;
+            continue;
+        }
+        if (c == '\\') {
+            if (i >= n) {
+                break;
+            }
+            c = data[i++];
+            if (c == '\r' && i < n && data[i] == '\n') {
+                ++i;
+                continue; // continuation line (CRLF)
+            }
+            switch (c) {
+            case '\n':
+                continue; // continuation line
+            case 't':
+                c = '\t';
+                break;
+            case 'b':
+                c = '\b';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            default:
+                break; // '\\', '"', and (leniently) anything else literally
+            }
+        }
+        value.append(c);
+    }
+    return QString::fromUtf8(value);
+}
+
+QList<Entry> parse(const QByteArray& data)
+{
+    QList<Entry> entries;
+    QString section; // "section" or "section.subsection"; empty before the first header
+    const int n = data.size();
+    int i = data.startsWith("\xef\xbb\xbf") ? 3 : 0; // UTF-8 BOM
+
+    const auto skipLine = [&]() {
+        while (i < n && data[i] != '\n') {
+            ++i;
+        }
+    };
+
+    while (i < n) {
+        const char c = data[i];
+        if (c == '\n' || isBlank(c)) {
+            ++i;
+            continue;
+        }
+        if (c == '#' || c == ';') {
+            skipLine();
+            continue;
+        }
+        if (c == '[') {
+            ++i;
+            if (!parseSectionHeader(data, i, section)) {
+                section.clear(); // ignore variables until the next good header
+                skipLine();
+            }
+            continue; // a variable may follow on the same line
+        }
+        if (!isKeyChar(c) || c == '-' || (c >= '0' && c <= '9')) {
+            skipLine(); // names must start with a letter
+            continue;
+        }
+
+        const int start = i;
+        while (i < n && isKeyChar(data[i])) {
+            ++i;
+        }
+        Entry entry;
+        entry.key = section + QLatin1Char('.') + QString::fromLatin1(data.mid(start, i - start)).toLower();
+        while (i < n && isBlank(data[i])) {
+            ++i;
+        }
+        if (i < n && data[i] == '=') {
+            ++i;
+            entry.value = parseValue(data, i);
+        } else if (i >= n || data[i] == '\n' || data[i] == '#' || data[i] == ';') {
+            entry.hasValue = false; // bare "name" means true
+            skipLine();
+        } else {
+            skipLine(); // malformed
+            continue;
+        }
+        if (!section.isEmpty()) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
+
+std::shared_ptr<const ParsedFile> parsedFile(const QString& path)
+{
+    const QFileInfo fi(path);
+    if (!fi.isFile()) {
+        QMutexLocker lock(&g_fileMutex);
+        g_fileCache.remove(path);
+        return nullptr;
+    }
+    const qint64 mtimeMs = fi.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fi.size();
+
+    {
+        QMutexLocker lock(&g_fileMutex);
+        const auto it = g_fileCache.constFind(path);
+        if (it != g_fileCache.constEnd() && it.value()->mtimeMs == mtimeMs && it.value()->size == size) {
+            return it.value();
+        }
+    }
+
+    // Parse outside the lock; a concurrent reparse of the same file is harmless.
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    auto parsed = std::make_shared<ParsedFile>();
+    parsed->mtimeMs = mtimeMs;
+    parsed->size = size;
+    parsed->entries = parse(f.readAll());
+
+    QMutexLocker lock(&g_fileMutex);
+    g_fileCache.insert(path, parsed);
+    return parsed;
+}
+
+// "section.subsection.name" -> its parts (subsection may be empty).
+void splitKey(const QString& key, QString& section, QString& subsection, QString& name)
+{
+    const int first = key.indexOf(QLatin1Char('.'));
+    const int last = key.lastIndexOf(QLatin1Char('.'));
+    section = key.left(first);
+    name = key.mid(last + 1);
+    subsection = last > first ? key.mid(first + 1, last - first - 1) : QString();
+}
+
+// Lower-case the case-insensitive parts of a key given by a caller.
+QString canonicalKey(const QString& key)
+{
+    const int first = key.indexOf(QLatin1Char('.'));
+    const int last = key.lastIndexOf(QLatin1Char('.'));
+    if (first < 0) {
+        return key.toLower();
+    }
+    return key.left(first).toLower() + key.mid(first, last - first) + key.mid(last).toLower();
+}
+
+QString expandPath(const QString& path, const QString& baseDir)
+{
+    if (path == QStringLiteral("~")) {
+        return QDir::homePath();
+    }
+    if (path.startsWith(QStringLiteral("~/"))) {
+        return QDir::homePath() + path.mid(1);
+    }
+    if (QDir::isRelativePath(path)) {
+        return QDir::cleanPath(baseDir + QLatin1Char('/') + path);
+    }
+    return path;
+}
+
+// wildmatch() with WM_PATHNAME, as used for includeIf patterns: '*' and '?'
+// stop at '/', "**/" matches any number of directories, a trailing "**" anything.
+bool globMatch(const QString& pattern, const QString& text, Qt::CaseSensitivity cs)
+{
+    QString rx;
+    for (int i = 0; i < pattern.size();) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('*')) {
+            if (i + 1 < pattern.size() && pattern.at(i + 1) == QLatin1Char('*')) {
+                if (i + 2 < pattern.size() && pattern.at(i + 2) == QLatin1Char('/')) {
+                    rx += QStringLiteral("(?:.*/)?");
+                    i += 3;
+                } else {
+                    rx += QStringLiteral(".*");
+                    i += 2;
+                }
+            } else {
+                rx += QStringLiteral("[^/]*");
+                ++i;
+            }
+        } else if (c == QLatin1Char('?')) {
+            rx += QStringLiteral("[^/]");
+            ++i;
+        } else if (c == QLatin1Char('[')) {
+            int j = i + 1;
+            if (j < pattern.size() && (pattern.at(j) == QLatin1Char('!') || pattern.at(j) == QLatin1Char('^'))) {
+                ++j;
+            }
+            if (j < pattern.size() && pattern.at(j) == QLatin1Char(']')) {
+                ++j;
+            }
+            const int close = pattern.indexOf(QLatin1Char(']'), j);
+            if (close < 0) {
+                rx += QRegularExpression::escape(QString(c));
+                ++i;
+                continue;
+            }
+            QString body = pattern.mid(i + 1, close - i - 1);
+            if (body.startsWith(QLatin1Char('!'))) {
+                body[0] = QLatin1Char('^');
+            }
+            body.replace(QLatin1Char('\\'), QStringLiteral("\\\\")).replace(QLatin1Char('['), QStringLiteral("\\["));
+            rx += QLatin1Char('[') + body + QLatin1Char(']');
+            i = close + 1;
+        } else if (c == QLatin1Char('\\') && i + 1 < pattern.size()) {
+            rx += QRegularExpression::escape(QString(pattern.at(i + 1)));
+            i += 2;
+        } else {
+            rx += QRegularExpression::escape(QString(c));
+            ++i;
+        }
+    }
+    const QRegularExpression re(QRegularExpression::anchoredPattern(rx),
+                                cs == Qt::CaseInsensitive ? QRegularExpression::CaseInsensitiveOption
+                                                          : QRegularExpression::NoPatternOption);
+    return re.match(text).hasMatch();
+}
+
+bool gitDirMatches(QString pattern, const GitRefDb::GitDirs& dirs, const QString& baseDir, Qt::CaseSensitivity cs)
+{
+    if (pattern.startsWith(QStringLiteral("~/"))) {
+        pattern = QDir::homePath() + pattern.mid(1);
+    } else if (pattern.startsWith(QStringLiteral("./"))) {
+        pattern = baseDir + pattern.mid(1); // relative to the including file
+    }
+    if (QDir::isRelativePath(pattern)) {
+        pattern.prepend(QStringLiteral("**/"));
+    }
+    if (pattern.endsWith(QLatin1Char('/'))) {
+        pattern += QStringLiteral("**");
+    }
+
+    // git tries the git dir as given and then with symlinks resolved.
+    const QString gitDir = QDir::cleanPath(QDir(dirs.gitDir).absolutePath());
+    if (globMatch(pattern, gitDir, cs)) {
+        return true;
+    }
+    const QString canonical = QFileInfo(gitDir).canonicalFilePath();
+    return !canonical.isEmpty() && canonical != gitDir && globMatch(pattern, canonical, cs);
+}
+
+bool conditionMatches(const QString& condition, const GitRefDb::GitDirs& dirs, const QString& baseDir)
+{
+    if (condition.startsWith(QStringLiteral("gitdir:"))) {
+        return gitDirMatches(condition.mid(7), dirs, baseDir, Qt::CaseSensitive);
+    }
+    if (condition.startsWith(QStringLiteral("gitdir/i:"))) {
+        return gitDirMatches(condition.mid(9), dirs, baseDir, Qt::CaseInsensitive);
+    }
+    if (condition.startsWith(QStringLiteral("onbranch:"))) {
+        const QString branch = GitRefDb::currentBranch(dirs);
+        QString pattern = condition.mid(9);
+        if (pattern.endsWith(QLatin1Char('/'))) {
+            pattern += QStringLiteral("**");
+        }
+        return !branch.isEmpty() && globMatch(pattern, branch, Qt::CaseSensitive);
+    }
+    return false; // hasconfig:, or a condition this git doesn't know either
+}
+
+void appendFile(const QString& path, const GitRefDb::GitDirs& dirs, QList<Entry>& entries, int depth)
+{
+    if (depth > kMaxIncludeDepth) {
+        return;
+    }
+    const auto parsed = parsedFile(path);
+    if (!parsed) {
+        return;
+    }
+
+    const QString baseDir = QFileInfo(path).absolutePath();
+    const QString includeIfPrefix = QStringLiteral("includeif.");
+    const QString pathSuffix = QStringLiteral(".path");
+    for (const Entry& entry : parsed->entries) {
+        entries.append(entry);
+        if (!entry.hasValue || entry.value.isEmpty()) {
+            continue;
+        }
+        // Included variables take effect right where the include appears.
+        if (entry.key == QStringLiteral("include.path")) {
+            appendFile(expandPath(entry.value, baseDir), dirs, entries, depth + 1);
+        } else if (entry.key.startsWith(includeIfPrefix) && entry.key.endsWith(pathSuffix)) {
+            const QString condition = entry.key.mid(includeIfPrefix.size(),
+                                                    entry.key.size() - includeIfPrefix.size() - pathSuffix.size());
+            if (conditionMatches(condition, dirs, baseDir)) {
+                appendFile(expandPath(entry.value, baseDir), dirs, entries, depth + 1);
+            }
+        }
+    }
+}
+
+bool isTruthy(const QString& value)
+{
+    return value.isEmpty() ? false
+                           : QString::compare(value, QStringLiteral("false"), Qt::CaseInsensitive) != 0
+                                 && QString::compare(value, QStringLiteral("no"), Qt::CaseInsensitive) != 0
+                                 && QString::compare(value, QStringLiteral("off"), Qt::CaseInsensitive) != 0
+                                 && value != QStringLiteral("0");
+}
+
+// Does one side of a refspec match ref? For a pattern, star gets what '*' covered.
+bool refspecSideMatches(const QString& side, const QString& ref, QString* star)
+{
+    const int at = side.indexOf(QLatin1Char('*'));
+    if (at < 0) {
+        return side == ref;
+    }
+    const QString prefix = side.left(at);
+    const QString suffix = side.mid(at + 1);
+    if (ref.size() < prefix.size() + suffix.size() || !ref.startsWith(prefix) || !ref.endsWith(suffix)) {
+        return false;
+    }
+    if (star) {
+        *star = ref.mid(prefix.size(), ref.size() - prefix.size() - suffix.size());
+    }
+    return true;
+}
+} // namespace
+
+QString Config::value(const QString& key, const QString& defaultValue) const
+{
+    const QString canonical = canonicalKey(key);
+    for (auto it = entries.crbegin(); it != entries.crend(); ++it) {
+        if (it->key == canonical) {
+            return it->value;
+        }
+    }
+    return defaultValue;
+}
+
+QStringList Config::values(const QString& key) const
+{
+    const QString canonical = canonicalKey(key);
+    QStringList result;
+    for (const Entry& entry : entries) {
+        if (entry.key == canonical) {
+            result.append(entry.value);
+        }
+    }
+    return result;
+}
+
+bool Config::boolValue(const QString& key, bool defaultValue) const
+{
+    const QString canonical = canonicalKey(key);
+    for (auto it = entries.crbegin(); it != entries.crend(); ++it) {
+        if (it->key == canonical) {
+            return !it->hasValue || isTruthy(it->value);
+        }
+    }
+    return defaultValue;
+}
+
+Config load(const GitRefDb::GitDirs& dirs)
+{
+    Config config;
+    if (!dirs.valid) {
+        return config;
+    }
+
+    // Same files, in the same order, as git: system, global, local, worktree.
+    if (!isTruthy(qEnvironmentVariable("GIT_CONFIG_NOSYSTEM"))) {
+        const QString system = qEnvironmentVariable("GIT_CONFIG_SYSTEM");
+        appendFile(system.isEmpty() ? QStringLiteral("/etc/gitconfig") : system, dirs, config.entries, 0);
+    }
+    const QString global = qEnvironmentVariable("GIT_CONFIG_GLOBAL");
+    if (!global.isEmpty()) {
+        appendFile(expandPath(global, QDir::currentPath()), dirs, config.entries, 0);
+    } else {
+        const QString xdg = qEnvironmentVariable("XDG_CONFIG_HOME");
+        appendFile(xdg.isEmpty() ? QDir::homePath() + QStringLiteral("/.config/git/config")
+                                 : xdg + QStringLiteral("/git/config"),
+                   dirs, config.entries, 0);
+        appendFile(QDir::homePath() + QStringLiteral("/.gitconfig"), dirs, config.entries, 0);
+    }
+    appendFile(dirs.commonDir + QStringLiteral("/config"), dirs, config.entries, 0);
+    if (config.boolValue(QStringLiteral("extensions.worktreeConfig"))) {
+        appendFile(dirs.gitDir + QStringLiteral("/config.worktree"), dirs, config.entries, 0);
+    }
+    return config;
+}
+
+QList<Remote> remotes(const Config& config)
+{
+    QList<Remote> found;
+    QHash<QString, int> indexByName;
+    QString section, subsection, name;
+    for (const Entry& entry : config.entries) {
+        if (!entry.key.startsWith(QStringLiteral("remote."))) {
+            continue;
+        }
+        splitKey(entry.key, section, subsection, name);
+        if (subsection.isEmpty() || (name != QStringLiteral("url") && name != QStringLiteral("fetch"))) {
+            continue;
+        }
+
+        int index = indexByName.value(subsection, -1);
+        if (index < 0) {
+            Remote remote;
+            remote.name = subsection;
+            found.append(remote);
+            index = found.size() - 1;
+            indexByName.insert(subsection, index);
+        }
+        Remote& remote = found[index];
+        if (name == QStringLiteral("url")) {
+            if (remote.url.isEmpty()) {
+                remote.url = entry.value; // fetches use the first URL
+            }
+        } else if (!entry.value.isEmpty()) {
+            remote.fetchRefspecs.append(entry.value);
+        }
+    }
+
+    QList<Remote> result;
+    for (Remote& remote : found) {
+        if (!remote.url.isEmpty()) {
+            remote.url = rewriteUrl(config, remote.url);
+            result.append(remote);
+        }
+    }
+    return result;
+}
+
+Remote remote(const Config& config, const QString& name)
+{
+    const QList<Remote> all = remotes(config);
+    for (const Remote& remote : all) {
+        if (remote.name == name) {
+            return remote;
+        }
+    }
+    return Remote();
+}
+
+bool branchUpstream(const Config& config, const QString& branch, QString& remote, QString& mergeRef)
+{
+    remote = config.value(QStringLiteral("branch.%1.remote").arg(branch));
+    mergeRef = config.value(QStringLiteral("branch.%1.merge").arg(branch));
+    return !remote.isEmpty() && !mergeRef.isEmpty();
+}
+
+QString rewriteUrl(const Config& config, const QString& url)
+{
+    QString base;
+    int matched = 0;
+    QString section, subsection, name;
+    for (const Entry& entry : config.entries) {
+        if (!entry.key.startsWith(QStringLiteral("url.")) || !entry.key.endsWith(QStringLiteral(".insteadof"))) {
+            continue;
+        }
+        splitKey(entry.key, section, subsection, name);
+        if (!entry.value.isEmpty() && entry.value.size() > matched && url.startsWith(entry.value)) {
+            base = subsection;
+            matched = entry.value.size();
+        }
+    }
+    return matched > 0 ? base + url.mid(matched) : url;
+}
+
+QString trackingRef(const QStringList& fetchRefspecs, const QString& remoteRef)
+{
+    // Negative refspecs ("^refs/heads/wip/*") exclude a ref outright.
+    for (const QString& spec : fetchRefspecs) {
+        if (spec.startsWith(QLatin1Char('^')) && refspecSideMatches(spec.mid(1), remoteRef, nullptr)) {
+            return QString();
+        }
+    }
+
+    for (QString spec : fetchRefspecs) {
+        if (spec.startsWith(QLatin1Char('+'))) {
+            spec.remove(0, 1);
+        }
+        const int colon = spec.indexOf(QLatin1Char(':'));
+        if (spec.startsWith(QLatin1Char('^')) || colon <= 0) {
+            continue; // negative, or fetched into FETCH_HEAD only
+        }
+        const QString source = spec.left(colon);
+        QString destination = spec.mid(colon + 1);
+        QString star;
+        if (!destination.isEmpty() && refspecSideMatches(source, remoteRef, &star)) {
+            return source.contains(QLatin1Char('*')) ? destination.replace(QLatin1Char('*'), star) : destination;
+        }
+    }
+    return QString();
+}
+
+} // namespace GitConfig
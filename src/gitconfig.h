@@ -0,0 +1,83 @@
+#ifndef GITCONFIG_H
+#define GITCONFIG_H
+
+#include "gitrefdb.h"
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * In-process reader for git's configuration, so remotes, fetch refspecs and
+ * branch upstreams are looked up without spawning git.
+ *
+ * load() assembles what git itself would see for a repository: the system and
+ * global files, the repository's `config` in the common dir and, when
+ * extensions.worktreeConfig is set, the worktree's `config.worktree`.
+ * `[include]` and `[includeIf "gitdir:..."]` / `"gitdir/i:..."` /
+ * `"onbranch:..."` are followed (`hasconfig:` conditions never match here).
+ * Command-line and GIT_CONFIG_COUNT settings are not seen.
+ *
+ * Everything here is read-only and thread-safe. Each parsed file is cached and
+ * revalidated against its mtime and size, like GitRefDb's packed-refs.
+ */
+namespace GitConfig {
+
+/**
+ * One variable. key is "section.name" or "section.subsection.name" with the
+ * section and name lower-cased (they are case-insensitive) and the subsection
+ * as written. A bare "name" line with no "=" has hasValue == false.
+ */
+struct Entry {
+    QString key;
+    QString value;
+    bool hasValue = true;
+};
+
+/** Every variable visible to a repository, in the order git reads them. */
+class Config
+{
+public:
+    QList<Entry> entries;
+
+    /** Last value of a key (git's "last one wins"), or defaultValue if unset. */
+    QString value(const QString& key, const QString& defaultValue = QString()) const;
+    /** All values of a multi-valued key, in order. */
+    QStringList values(const QString& key) const;
+    bool boolValue(const QString& key, bool defaultValue = false) const;
+};
+
+/** Load the configuration a repository sees. Empty if dirs isn't valid. */
+Config load(const GitRefDb::GitDirs& dirs);
+
+struct Remote {
+    QString name;
+    QString url;                // first remote.<name>.url, url.<base>.insteadOf applied
+    QStringList fetchRefspecs;  // remote.<name>.fetch, in order
+};
+
+/** Remotes that have a URL, in the order they first appear. */
+QList<Remote> remotes(const Config& config);
+
+/** One remote by name; the name is empty if it isn't configured. */
+Remote remote(const Config& config, const QString& name);
+
+/**
+ * The configured upstream of a local branch (branch.<name>.remote and
+ * branch.<name>.merge). Returns false if the branch has no upstream.
+ */
+bool branchUpstream(const Config& config, const QString& branch, QString& remote, QString& mergeRef);
+
+/** Apply url.<base>.insteadOf rewriting (longest matching prefix wins). */
+QString rewriteUrl(const Config& config, const QString& url);
+
+/**
+ * The local ref a fetch stores the remote's ref in, according to the fetch
+ * refspecs (with the default refspec, "refs/heads/main" of origin maps to
+ * "refs/remotes/origin/main"). Empty if no refspec maps it or a negative
+ * refspec excludes it.
+ */
+QString trackingRef(const QStringList& fetchRefspecs, const QString& remoteRef);
+
+} // namespace GitConfig
+
+#endif // GITCONFIG_H
@@ -1,161 +1,305 @@
 #include "gitfetchworker.h"
+#include "fetchprogress.h"
+#include "gitconfig.h"
+#include "gitrefdb.h"
 #include "gitutils.h"
-#include <QtConcurrent>
-#include <QFuture>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QPointer>
 #include <QProcess>
 #include <QProcessEnvironment>
 #include <QSet>
 #include <QStringList>
 #include <QTimer>
 #include <QThread>
+#include <QThreadPool>
 #include <QDebug>
+#include <QtConcurrent>
 #include <chrono>
 #include <memory>
 
-namespace {
 // Shared aggregation state for the remotes of a single repository fetch. The
-// per-remote pool tasks and the watchdog all hold a shared_ptr to it; whichever
-// completes the set (or times out) first finalizes and emits fetchFinished.
-struct RepoFetchState {
-    QMutex mutex;
-    QString repoName;
+// remote jobs and the watchdog all hold a shared_ptr to it; whichever completes
+// the set (or times out) first finalizes and emits fetchFinished.
+struct GitFetchWorker::RepoFetchState {
+    RepositoryId repoId = 0;
     QString repoPath;
     QStringList remoteNames;
     QStringList tagsBefore; // tag snapshot taken before any remote fetched
+    bool tagsKnown = false; // tagsBefore has been taken
+    std::chrono::steady_clock::time_point deadline;
     QSet<QString> completed;
     QStringList failed;
     bool allSuccessful = true;
     bool finished = false;
     int timeoutSeconds = 0;
 };
+
+// One `git fetch <remote>` (optionally preceded by an `ls-remote` probe),
+// queued or running, and every repository fetch waiting on it. The fetch that
+// created it is the first waiter; duplicate requests join the list.
+struct GitFetchWorker::RemoteJob {
+    QString key;
+    QString repoPath;
+    GitRemote remote;
+    std::chrono::steady_clock::time_point deadline;
+    QList<std::shared_ptr<RepoFetchState>> waiters;
+    Stage stage = Stage::Probe;
+    QPointer<QProcess> process; // the current stage's process, while running
+    QByteArray output;          // captured stdout of the probe stage
+    FetchProgressParser progressParser; // fetch stage sideband output
+    QString lastPhase;
+    qint64 lastProgressMs = 0;  // when progress was last reported (throttling)
+    bool running = false;       // holds one of the m_maxConcurrent slots
+    bool checkingObjects = false; // probe done, tag objects being looked up off-thread
+    qint64 startedMs = 0;       // when it took the slot, for the journal
+    qint64 bytesReceived = -1;  // latest byte count git reported
+    int exitCode = -1;          // of the last stage's process, if it exited
+    // Set before killing the process so its finished() is reported correctly.
+    RunOutcome abortOutcome = RunOutcome::Succeeded;
+};
+
+namespace {
+// Remote status transitions are delivered in batches at most this often.
+constexpr int kStatusBatchMs = 16;
+
+// Registry key: the shared git directory (worktrees of one repository fight
+// over the same ref locks) plus the remote name.
+QString inFlightKey(const QString& repoPath, const QString& remoteName)
+{
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(repoPath);
+    const QString dir = dirs.valid ? dirs.commonDir : repoPath;
+    const QString canonical = QFileInfo(dir).canonicalFilePath();
+    return (canonical.isEmpty() ? dir : canonical) + QLatin1Char('\n') + remoteName;
+}
+
+// Tag names ("v1.2.0") read straight from the ref files, in name order.
+// Returns false if the ref storage can't be read here (e.g. reftable), in
+// which case only `git tag` can answer.
+bool readTags(const QString& repoPath, QStringList* tags)
+{
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(repoPath);
+    if (!GitRefDb::isSupported(dirs)) {
+        return false;
+    }
+    const QString prefix = QStringLiteral("refs/tags/");
+    const QMap<QString, QString> refs = GitRefDb::listRefs(dirs, prefix);
+    tags->clear();
+    tags->reserve(refs.size());
+    for (auto it = refs.constBegin(); it != refs.constEnd(); ++it) {
+        tags->append(it.key().mid(prefix.size()));
+    }
+    return true;
+}
 } // namespace
 
 GitFetchWorker::GitFetchWorker(QObject *parent)
     : QObject(parent)
-    , m_stopRequested(false)
     , m_timeoutSeconds(300) // Default 5 minutes
     , m_connectionTimeoutSeconds(5) // Default 5 seconds
-{
+    , m_probeFirst(false)
+    , m_probeSkips(0)
     // Bound concurrency so a burst of repositories/remotes doesn't spawn an
     // unbounded number of network processes, while still letting independent
-    // remotes fetch in parallel.
-    m_pool.setMaxThreadCount(qMax(4, QThread::idealThreadCount() * 2));
+    // remotes fetch in parallel. No thread is tied up per process, so this
+    // can be raised well beyond the core count.
+    , m_maxConcurrent(qMax(4, QThread::idealThreadCount() * 2))
+    , m_running(0)
+    , m_statusFlushTimer(new QTimer(this)) // moves to the worker thread with us
+    , m_gitPool(new QThreadPool(this))
+{
+    m_statusFlushTimer->setSingleShot(true);
+    m_statusFlushTimer->setInterval(kStatusBatchMs);
+    connect(m_statusFlushTimer, &QTimer::timeout, this, &GitFetchWorker::flushRemoteStatuses);
 }
 
 GitFetchWorker::~GitFetchWorker()
 {
+    // Pool tasks post their results back to us; none may outlive the worker.
+    m_gitPool->clear();
+    m_gitPool->waitForDone();
 }
 
 void GitFetchWorker::fetchRepository(const GitRepository& repo)
 {
-    m_stopRequested = false;
-    emit fetchStarted(repo.name);
+    emit fetchStarted(repo.id);
 
     if (repo.remotes.isEmpty()) {
-        emit fetchError(repo.name, "No remotes configured");
+        flushRemoteStatuses();
+        emit fetchError(repo.id, "No remotes configured");
         return;
     }
 
     if (!GitUtils::isRepositoryValid(repo.localPath)) {
-        emit fetchError(repo.name, QString("Repository not found at: %1").arg(repo.localPath));
+        flushRemoteStatuses();
+        emit fetchError(repo.id, QString("Repository not found at: %1").arg(repo.localPath));
         return;
     }
 
-    const int timeoutSeconds = m_timeoutSeconds.load();
+    const int timeoutSeconds = m_timeoutSeconds;
     const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
 
     auto state = std::make_shared<RepoFetchState>();
-    state->repoName = repo.name;
+    state->repoId = repo.id;
     state->repoPath = repo.localPath;
     state->timeoutSeconds = timeoutSeconds;
-    // Snapshot tags up front so we can report any that the fetch brings in.
-    state->tagsBefore = GitUtils::listTags(repo.localPath);
+    state->deadline = deadline;
     for (const GitRemote& remote : repo.remotes) {
         state->remoteNames.append(remote.name);
-        emit remoteStatusChanged(repo.name, remote.name, QStringLiteral("Queued"));
+        queueRemoteStatus(repo.id, remote.name, FetchStatus::Queued);
     }
 
-    // Dispatch each remote onto the bounded pool with its own git process so one
-    // slow/hung remote cannot block its siblings.
-    for (const GitRemote& remote : repo.remotes) {
-        const QString repoName = repo.name;
+    // Snapshot tags up front so we can report any that the fetch brings in.
+    // This thread drives every running fetch, so it never waits on a git
+    // process: when the ref files can't be read, `git tag` runs on the pool
+    // and the remotes are queued once its answer is back.
+    if (readTags(repo.localPath, &state->tagsBefore)) {
+        state->tagsKnown = true;
+        queueRemotes(state, repo.remotes);
+    } else {
+        m_awaitingTags.append(state);
         const QString repoPath = repo.localPath;
-        const GitRemote r = remote;
-        [[maybe_unused]] QFuture<void> f = QtConcurrent::run(&m_pool, [this, repoName, repoPath, r, deadline, state]() {
-            {
-                QMutexLocker lk(&state->mutex);
-                if (state->finished) {
-                    return; // repository fetch already finalized (e.g. timed out)
-                }
-            }
-
-            QString statusLabel;
-            const bool ok = fetchOneRemote(repoName, repoPath, r, deadline, statusLabel);
-
-            bool doFinalize = false;
-            bool finishSuccess = false;
-            QString finishMessage;
-            {
-                QMutexLocker lk(&state->mutex);
-                if (state->finished || state->completed.contains(r.name)) {
-                    return;
-                }
-                state->completed.insert(r.name);
-                emit remoteStatusChanged(repoName, r.name, statusLabel);
-                if (!ok) {
-                    state->allSuccessful = false;
-                    state->failed.append(r.name);
+        const QList<GitRemote> remotes = repo.remotes;
+        [[maybe_unused]] QFuture<void> future = QtConcurrent::run(m_gitPool, [this, state, repoPath, remotes]() {
+            const QStringList tags = GitUtils::listTags(repoPath);
+            QMetaObject::invokeMethod(this, [this, state, remotes, tags]() {
+                if (!m_awaitingTags.removeOne(state) || state->finished) {
+                    return; // stopped or timed out meanwhile
                 }
-                if (state->completed.size() == state->remoteNames.size()) {
-                    state->finished = true;
-                    doFinalize = true;
-                    finishSuccess = state->allSuccessful;
-                    finishMessage = state->allSuccessful
-                                        ? QStringLiteral("All remotes fetched successfully")
-                                        : QString("Some remotes failed: %1").arg(state->failed.join(", "));
-                }
-            }
-            // Tag diff + fetchFinished are done outside the lock: they touch git
-            // (I/O) and only run once finalized, when no other task will mutate state.
-            if (doFinalize) {
-                emit fetchFinished(repoName, finishSuccess, finishMessage);
-                checkForNewTags(repoName, repoPath, state->tagsBefore);
-            }
+                state->tagsBefore = tags;
+                state->tagsKnown = true;
+                queueRemotes(state, remotes);
+            }, Qt::QueuedConnection);
         });
     }
 
-    // Watchdog backstop: each remote process already self-terminates at the
-    // deadline / on a stall, but this guarantees the UI is finalized even in the
-    // unlikely event a process is slow to die. It marks any still-pending remotes
-    // as timed out and finalizes the repository.
+    // Watchdog backstop: each remote process is killed at the deadline, but
+    // this guarantees the UI is finalized even for remotes still waiting for a
+    // free slot, or joined to a fetch started by an earlier request. It marks
+    // any still-pending remotes as timed out and finalizes the repository.
     QTimer::singleShot(timeoutSeconds * 1000, this, [this, state]() {
-        QString message;
-        {
-            QMutexLocker lk(&state->mutex);
-            if (state->finished) {
-                return;
-            }
-            state->finished = true;
-            for (const QString& name : std::as_const(state->remoteNames)) {
-                if (!state->completed.contains(name)) {
-                    emit remoteStatusChanged(state->repoName, name, QStringLiteral("Timeout"));
-                    state->failed.append(name + " (timed out)");
-                    state->allSuccessful = false;
-                }
+        if (state->finished) {
+            return;
+        }
+        state->finished = true;
+        m_awaitingTags.removeOne(state);
+        for (const QString& name : std::as_const(state->remoteNames)) {
+            if (!state->completed.contains(name)) {
+                queueRemoteStatus(state->repoId, name, FetchStatus::Timeout);
+                state->failed.append(name + " (timed out)");
+                state->allSuccessful = false;
             }
-            message = QString("Fetch timed out after %1 seconds").arg(state->timeoutSeconds);
         }
-        emit fetchFinished(state->repoName, false, message);
+        flushRemoteStatuses();
+        emit fetchFinished(state->repoId, false,
+                           QString("Fetch timed out after %1 seconds").arg(state->timeoutSeconds));
         // Remotes that completed before the deadline may still have delivered tags.
-        checkForNewTags(state->repoName, state->repoPath, state->tagsBefore);
+        checkForNewTags(state);
     });
 }
 
+void GitFetchWorker::queueRemotes(const std::shared_ptr<RepoFetchState>& state, const QList<GitRemote>& remotes)
+{
+    // Each remote gets its own git process so one slow/hung remote cannot block
+    // its siblings. A remote that is already queued or being fetched for this
+    // repository (a duplicate request, or the same repository tracked under
+    // another name / worktree) is joined rather than fetched again: concurrent
+    // fetches would only contend for FETCH_HEAD and the ref locks.
+    for (const GitRemote& remote : remotes) {
+        const QString key = inFlightKey(state->repoPath, remote.name);
+        const auto existing = m_inFlight.constFind(key);
+        if (existing != m_inFlight.constEnd()) {
+            existing.value()->waiters.append(state);
+            if (existing.value()->running) {
+                queueRemoteStatus(state->repoId, remote.name, FetchStatus::Fetching);
+            }
+            continue;
+        }
+
+        auto job = std::make_shared<RemoteJob>();
+        job->key = key;
+        job->repoPath = state->repoPath;
+        job->remote = remote;
+        job->deadline = state->deadline;
+        job->waiters.append(state);
+        m_inFlight.insert(key, job);
+        m_queue.append(job);
+    }
+    startQueuedJobs();
+}
+
+void GitFetchWorker::completeRemote(const std::shared_ptr<RepoFetchState>& state, const QString& remoteName,
+                                    bool ok, FetchStatus status)
+{
+    if (state->finished || state->completed.contains(remoteName)) {
+        return;
+    }
+    state->completed.insert(remoteName);
+    queueRemoteStatus(state->repoId, remoteName, status);
+    if (!ok) {
+        state->allSuccessful = false;
+        state->failed.append(remoteName);
+    }
+    if (state->completed.size() < state->remoteNames.size()) {
+        return;
+    }
+
+    state->finished = true;
+    const QString message = state->allSuccessful
+                                ? QStringLiteral("All remotes fetched successfully")
+                                : QString("Some remotes failed: %1").arg(state->failed.join(", "));
+    flushRemoteStatuses();
+    emit fetchFinished(state->repoId, state->allSuccessful, message);
+    checkForNewTags(state);
+}
+
+void GitFetchWorker::queueRemoteStatus(RepositoryId repoId, const QString& remoteName, FetchStatus status)
+{
+    m_pendingStatuses.append({repoId, remoteName, status});
+    if (!m_statusFlushTimer->isActive()) {
+        m_statusFlushTimer->start();
+    }
+}
+
+void GitFetchWorker::flushRemoteStatuses()
+{
+    m_statusFlushTimer->stop();
+    if (!m_pendingStatuses.isEmpty()) {
+        emit remoteStatusesChanged(std::exchange(m_pendingStatuses, {}));
+    }
+}
+
 void GitFetchWorker::stopFetching()
 {
-    m_stopRequested = true;
+    // Repository fetches still waiting for their tag snapshot never queued
+    // anything; cancel them as a whole.
+    const QList<std::shared_ptr<RepoFetchState>> awaiting = std::exchange(m_awaitingTags, {});
+    for (const auto& state : awaiting) {
+        for (const QString& name : std::as_const(state->remoteNames)) {
+            completeRemote(state, name, false, FetchStatus::Cancelled);
+        }
+    }
+    // Remotes still waiting for a slot are cancelled outright...
+    const QList<std::shared_ptr<RemoteJob>> queued = std::exchange(m_queue, {});
+    for (const auto& job : queued) {
+        m_inFlight.remove(job->key);
+        for (const auto& waiter : std::as_const(job->waiters)) {
+            completeRemote(waiter, job->remote.name, false, FetchStatus::Cancelled);
+        }
+    }
+    // ...and running ones are killed and reported now. Their finished() may
+    // never be delivered (on shutdown the thread stops right after this), so
+    // the process is detached from the job first and its handler ignores it.
+    // A probe whose tag objects are being looked up has no process to kill.
+    const QList<std::shared_ptr<RemoteJob>> running = m_inFlight.values();
+    for (const auto& job : running) {
+        if (QProcess *proc = job->process) {
+            job->process = nullptr;
+            job->exitCode = -1;
+            proc->kill();
+        }
+        finishJob(job, false, FetchStatus::Cancelled);
+    }
 }
 
 void GitFetchWorker::setTimeout(int timeoutSeconds)
@@ -168,18 +312,20 @@ void GitFetchWorker::setConnectionTimeout(int timeoutSeconds)
     m_connectionTimeoutSeconds = timeoutSeconds;
 }
 
-bool GitFetchWorker::fetchOneRemote(const QString& repoName, const QString& repoPath, const GitRemote& remote,
-                                    std::chrono::steady_clock::time_point deadline, QString& statusLabel)
+void GitFetchWorker::setProbeBeforeFetch(bool enabled)
 {
-    emit remoteStatusChanged(repoName, remote.name, QStringLiteral("Fetching..."));
+    m_probeFirst = enabled;
+}
 
-    const int connectSeconds = qMax(1, m_connectionTimeoutSeconds.load());
+void GitFetchWorker::setMaxConcurrentFetches(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    startQueuedJobs();
+}
 
-    QProcess proc;
-    // Merge stderr (where git writes --progress sideband) into stdout so we can
-    // drain a single channel. We do NOT use output for stall detection anymore:
-    // doing so would kill an in-progress passphrase prompt (which is silent).
-    proc.setProcessChannelMode(QProcess::MergedChannels);
+QProcessEnvironment GitFetchWorker::networkEnvironment() const
+{
+    const int connectSeconds = qMax(1, m_connectionTimeoutSeconds);
 
     // Base = the user's resolved login/interactive shell environment (so SSH
     // agent, askpass and PATH match a terminal they opened), with
@@ -201,61 +347,351 @@ bool GitFetchWorker::fetchOneRemote(const QString& repoName, const QString& repo
     //    human typing a passphrase) and exit on its own.
     sshCmd += QStringLiteral(" -o ConnectTimeout=%1 -o ServerAliveInterval=%1 -o ServerAliveCountMax=3").arg(connectSeconds);
     env.insert(QStringLiteral("GIT_SSH_COMMAND"), sshCmd);
-    proc.setProcessEnvironment(env);
+    return env;
+}
 
+QStringList GitFetchWorker::networkGitArgs(const QString& repoPath, const QStringList& command) const
+{
+    const int connectSeconds = qMax(1, m_connectionTimeoutSeconds);
     // HTTP(S) analog of ssh keepalive death-detection: abort if throughput stays
     // effectively dead (< 1 byte/s) for a sustained window.
     const int httpStallSeconds = qMax(connectSeconds * 3, 30);
-    const QStringList args = {QStringLiteral("-C"), repoPath,
-                              QStringLiteral("-c"), QStringLiteral("http.lowSpeedLimit=1"),
-                              QStringLiteral("-c"), QStringLiteral("http.lowSpeedTime=%1").arg(httpStallSeconds),
-                              QStringLiteral("fetch"), QStringLiteral("--progress"),
-                              remote.name};
-    proc.start(QStringLiteral("git"), args);
-    if (!proc.waitForStarted(5000)) {
-        statusLabel = QStringLiteral("Error");
+    QStringList args = {QStringLiteral("-C"), repoPath,
+                        QStringLiteral("-c"), QStringLiteral("http.lowSpeedLimit=1"),
+                        QStringLiteral("-c"), QStringLiteral("http.lowSpeedTime=%1").arg(httpStallSeconds)};
+    args += command;
+    return args;
+}
+
+bool GitFetchWorker::remoteMatchesLocal(const QString& repoPath, const GitRemote& remote, const QByteArray& advertised,
+                                        QStringList* tagObjects) const
+{
+    tagObjects->clear();
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(repoPath);
+    if (!GitRefDb::isSupported(dirs)) {
         return false;
     }
 
+    const QString headsPrefix = QStringLiteral("refs/heads/");
+    const QString tagsPrefix = QStringLiteral("refs/tags/");
+    const QMap<QString, QString> localTags = GitRefDb::listRefs(dirs, tagsPrefix);
+
+    // Heads are compared where the remote's fetch refspecs store them; a
+    // remote without any gets git's default refs/remotes/<remote>/* layout.
+    QStringList refspecs = GitConfig::remote(GitConfig::load(dirs), remote.name).fetchRefspecs;
+    if (refspecs.isEmpty()) {
+        refspecs.append(QStringLiteral("+refs/heads/*:refs/remotes/%1/*").arg(remote.name));
+    }
+
+    // `ls-remote` prints "<object>\t<ref>", with "<ref>^{}" lines giving the
+    // commit an annotated tag points at.
+    QHash<QString, QString> tags;   // tag ref -> advertised object
+    QHash<QString, QString> peeled; // tag ref -> commit it points at
+    const QList<QByteArray> lines = advertised.split('\n');
+    for (const QByteArray& raw : lines) {
+        const QString line = QString::fromUtf8(raw).trimmed();
+        const int tab = line.indexOf(QLatin1Char('\t'));
+        if (tab <= 0) {
+            continue;
+        }
+        const QString sha = line.left(tab);
+        QString ref = line.mid(tab + 1);
+        if (ref.startsWith(headsPrefix)) {
+            // A head no refspec maps (e.g. in a single-branch clone) is never fetched.
+            const QString local = GitConfig::trackingRef(refspecs, ref);
+            if (!local.isEmpty() && GitRefDb::resolve(dirs, local) != sha) {
+                return false;
+            }
+        } else if (ref.startsWith(tagsPrefix)) {
+            if (ref.endsWith(QStringLiteral("^{}"))) {
+                ref.chop(3);
+                peeled.insert(ref, sha);
+            } else {
+                tags.insert(ref, sha);
+            }
+        }
+    }
+
+    // A tag we don't have (or that moved) only matters if a fetch would bring
+    // it in: tags are auto-followed when they point at history we already
+    // have, so only those count as a difference. Tags into unfetched history
+    // would never arrive and must not defeat the skip forever.
+    // Whether those objects exist takes git to answer, so that is left to
+    // the caller.
+    for (auto it = tags.constBegin(); it != tags.constEnd(); ++it) {
+        if (localTags.value(it.key()) != it.value()) {
+            // "^{object}" makes every resolver path check the object exists
+            // (a bare 40-hex name would pass `rev-parse --verify` regardless).
+            tagObjects->append(peeled.value(it.key(), it.value()) + QStringLiteral("^{object}"));
+        }
+    }
+    return true;
+}
+
+bool GitFetchWorker::hasPendingWaiter(const RemoteJob& job) const
+{
+    for (const auto& waiter : job.waiters) {
+        if (!waiter->finished) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GitFetchWorker::startQueuedJobs()
+{
+    while (m_running < m_maxConcurrent && !m_queue.isEmpty()) {
+        const std::shared_ptr<RemoteJob> job = m_queue.takeFirst();
+        // Every repository fetch waiting on it was already finalized (e.g. timed
+        // out) while it sat in the queue: nothing to do.
+        if (!hasPendingWaiter(*job)) {
+            m_inFlight.remove(job->key);
+            continue;
+        }
+
+        ++m_running;
+        job->running = true;
+        job->startedMs = QDateTime::currentMSecsSinceEpoch();
+        for (const auto& waiter : std::as_const(job->waiters)) {
+            if (!waiter->finished) {
+                queueRemoteStatus(waiter->repoId, job->remote.name, FetchStatus::Fetching);
+            }
+        }
+        // Probe-first mode: a ref advertisement is far cheaper than a fetch
+        // (no negotiation, pack checks or auto-gc), so skip the fetch when the
+        // remote hasn't moved.
+        startStage(job, m_probeFirst ? Stage::Probe : Stage::Fetch);
+    }
+}
+
+void GitFetchWorker::startStage(const std::shared_ptr<RemoteJob>& job, Stage stage)
+{
+    job->stage = stage;
+    job->output.clear();
+    job->exitCode = -1;
+    job->abortOutcome = RunOutcome::Succeeded;
+
+    const QStringList command = (stage == Stage::Probe)
+        ? QStringList{QStringLiteral("ls-remote"), QStringLiteral("--heads"), QStringLiteral("--tags"), job->remote.name}
+        : QStringList{QStringLiteral("fetch"), QStringLiteral("--progress"), job->remote.name};
+
+    // Driven entirely by QProcess signals on this thread: no thread is parked
+    // per process, and kill() on stop/deadline takes effect immediately.
+    auto *proc = new QProcess(this);
+    job->process = proc;
+    // The fetch merges stderr (where git writes --progress sideband) into
+    // stdout so a single channel is drained; nothing watches it for stalls,
+    // since that would kill an in-progress passphrase prompt (which is
+    // silent). The probe's stdout is the ref advertisement we parse.
+    proc->setProcessChannelMode(stage == Stage::Probe ? QProcess::SeparateChannels : QProcess::MergedChannels);
+    QProcessEnvironment env = networkEnvironment();
+    if (stage == Stage::Fetch) {
+        // FetchProgressParser only knows git's English phase names and units.
+        // LC_MESSAGES/LANGUAGE rather than LC_ALL, so paths and ssh prompts
+        // keep the user's encoding.
+        env.insert(QStringLiteral("LC_MESSAGES"), QStringLiteral("C"));
+        env.insert(QStringLiteral("LANGUAGE"), QStringLiteral("C"));
+    }
+    proc->setProcessEnvironment(env);
+
+    connect(proc, &QProcess::readyReadStandardOutput, this, [this, job, proc]() {
+        const QByteArray chunk = proc->readAllStandardOutput(); // drain; don't let a full pipe block git
+        if (job->stage == Stage::Probe) {
+            job->output += chunk;
+        } else {
+            reportProgress(job, job->progressParser.feed(chunk));
+        }
+    });
+    connect(proc, &QProcess::readyReadStandardError, this, [proc]() {
+        proc->readAllStandardError();
+    });
+    connect(proc, &QProcess::finished, this, [this, job, proc](int exitCode, QProcess::ExitStatus exitStatus) {
+        const QByteArray tail = proc->readAllStandardOutput(); // drain any trailing output
+        if (job->stage == Stage::Probe) {
+            job->output += tail;
+        } else {
+            reportProgress(job, job->progressParser.feed(tail));
+        }
+        proc->deleteLater();
+        if (job->process != proc) {
+            return;
+        }
+        job->process = nullptr;
+        job->exitCode = (exitStatus == QProcess::NormalExit) ? exitCode : -1;
+        RunOutcome outcome = job->abortOutcome;
+        if (outcome == RunOutcome::Succeeded && (exitStatus != QProcess::NormalExit || exitCode != 0)) {
+            outcome = RunOutcome::Failed;
+        }
+        onStageFinished(job, outcome);
+    });
+    connect(proc, &QProcess::errorOccurred, this, [this, job, proc](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart || job->process != proc) {
+            return; // other errors are followed by finished()
+        }
+        proc->deleteLater();
+        job->process = nullptr;
+        onStageFinished(job, RunOutcome::Failed);
+    });
+
     // The overall deadline is the hard backstop (it also bounds how long a
     // passphrase prompt may sit). Mid-flight network stalls are handled by the
-    // ssh/http options above, so we don't need a no-output timer here -- we just
-    // drain output so a chatty fetch can't block on a full pipe, and poll for
-    // cancellation / the deadline.
-    enum class AbortReason { None, Stop, Deadline } reason = AbortReason::None;
-
-    for (;;) {
-        if (proc.waitForReadyRead(200)) {
-            proc.readAll(); // drain; don't let a full pipe block git
-        }
+    // ssh/http options, so there is no no-output timer.
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        job->deadline - std::chrono::steady_clock::now());
+    auto *deadlineTimer = new QTimer(proc);
+    deadlineTimer->setSingleShot(true);
+    connect(deadlineTimer, &QTimer::timeout, proc, [job, proc]() {
+        job->abortOutcome = RunOutcome::TimedOut;
+        proc->kill();
+    });
+    deadlineTimer->start(int(qMax<qint64>(0, remaining.count())));
+
+    proc->start(QStringLiteral("git"), networkGitArgs(job->repoPath, command));
+}
 
-        if (proc.state() == QProcess::NotRunning) {
-            proc.readAll(); // drain any trailing output
-            break;
+void GitFetchWorker::reportProgress(const std::shared_ptr<RemoteJob>& job, const QList<FetchProgress>& reports)
+{
+    if (reports.isEmpty()) {
+        return;
+    }
+    for (const FetchProgress& report : reports) {
+        if (report.bytes >= 0) {
+            job->bytesReceived = report.bytes; // kept even when not reported on
         }
+    }
+    // git redraws its progress line many times a second; pass on phase changes
+    // and completions as they happen, and the latest state at most every
+    // kProgressIntervalMs otherwise.
+    constexpr qint64 kProgressIntervalMs = 250;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const FetchProgress& latest = reports.last();
+    bool phaseChanged = false;
+    for (const FetchProgress& report : reports) {
+        phaseChanged = phaseChanged || report.done || report.phase != job->lastPhase;
+    }
+    if (!phaseChanged && now - job->lastProgressMs < kProgressIntervalMs) {
+        return;
+    }
+    job->lastPhase = latest.phase;
+    job->lastProgressMs = now;
+    flushRemoteStatuses(); // "Fetching..." first: it resets the progress shown
+    for (const auto& waiter : std::as_const(job->waiters)) {
+        if (!waiter->finished) {
+            emit fetchProgress(waiter->repoId, job->remote.name, latest);
+        }
+    }
+}
 
-        const auto now = std::chrono::steady_clock::now();
-        if (m_stopRequested.load()) { reason = AbortReason::Stop; break; }
-        if (now >= deadline) { reason = AbortReason::Deadline; break; }
+void GitFetchWorker::onStageFinished(const std::shared_ptr<RemoteJob>& job, RunOutcome outcome)
+{
+    if (outcome == RunOutcome::Cancelled) {
+        finishJob(job, false, FetchStatus::Cancelled);
+        return;
+    }
+    if (outcome == RunOutcome::TimedOut) {
+        finishJob(job, false, FetchStatus::Timeout);
+        return;
     }
 
-    if (reason != AbortReason::None) {
-        proc.kill();
-        proc.waitForFinished(2000);
-        statusLabel = (reason == AbortReason::Stop) ? QStringLiteral("Cancelled")
-                                                    : QStringLiteral("Timeout");
-        return false;
+    if (job->stage == Stage::Probe) {
+        // A failed probe just falls through to the fetch, which reports the
+        // real error.
+        QStringList tagObjects;
+        if (outcome != RunOutcome::Succeeded || !remoteMatchesLocal(job->repoPath, job->remote, job->output, &tagObjects)) {
+            startStage(job, Stage::Fetch);
+        } else if (tagObjects.isEmpty()) {
+            skipFetch(job);
+        } else {
+            // Looking the objects up means talking to git; do it on the pool
+            // so this thread keeps serving the other fetches meanwhile.
+            job->checkingObjects = true;
+            const QString repoPath = job->repoPath;
+            [[maybe_unused]] QFuture<void> future = QtConcurrent::run(m_gitPool, [this, job, repoPath, tagObjects]() {
+                const QStringList present = GitUtils::resolveRefs(repoPath, tagObjects);
+                QMetaObject::invokeMethod(this, [this, job, present]() {
+                    job->checkingObjects = false;
+                    if (!job->running) {
+                        return; // cancelled meanwhile
+                    }
+                    if (std::chrono::steady_clock::now() >= job->deadline) {
+                        finishJob(job, false, FetchStatus::Timeout);
+                        return;
+                    }
+                    for (const QString& objectName : present) {
+                        if (!objectName.isEmpty()) {
+                            startStage(job, Stage::Fetch);
+                            return;
+                        }
+                    }
+                    skipFetch(job);
+                }, Qt::QueuedConnection);
+            });
+        }
+        return;
     }
 
-    proc.waitForFinished(2000);
-    const bool success = (proc.exitStatus() == QProcess::NormalExit && proc.exitCode() == 0);
-    statusLabel = success ? QStringLiteral("Success") : QStringLiteral("Error");
-    return success;
+    const bool ok = (outcome == RunOutcome::Succeeded);
+    finishJob(job, ok, ok ? FetchStatus::Success : FetchStatus::Error);
+}
+
+void GitFetchWorker::skipFetch(const std::shared_ptr<RemoteJob>& job)
+{
+    emit probeSkipsChanged(++m_probeSkips);
+    finishJob(job, true, FetchStatus::UpToDate);
+}
+
+void GitFetchWorker::finishJob(const std::shared_ptr<RemoteJob>& job, bool ok, FetchStatus status)
+{
+    // Retire the registry entry before reporting, so a request arriving from
+    // here on starts a fresh fetch instead of joining a finished one.
+    if (m_inFlight.value(job->key) == job) {
+        m_inFlight.remove(job->key);
+    }
+    if (job->running) {
+        job->running = false;
+        --m_running;
+    }
+    for (const auto& waiter : std::as_const(job->waiters)) {
+        completeRemote(waiter, job->remote.name, ok, status);
+    }
+
+    RemoteFetchRecord record;
+    record.repoPath = job->repoPath;
+    record.remoteName = job->remote.name;
+    record.url = job->remote.url;
+    record.startMs = job->startedMs;
+    record.endMs = QDateTime::currentMSecsSinceEpoch();
+    record.bytes = job->bytesReceived;
+    record.outcome = status;
+    record.exitCode = job->exitCode;
+    emit remoteFetchRecorded(record);
+
+    startQueuedJobs();
+}
+
+void GitFetchWorker::checkForNewTags(const std::shared_ptr<RepoFetchState>& state)
+{
+    if (!state->tagsKnown) {
+        return; // finalized before the snapshot was taken: nothing to compare
+    }
+    QStringList tagsAfter;
+    if (readTags(state->repoPath, &tagsAfter)) {
+        reportNewTags(state->repoId, state->tagsBefore, tagsAfter);
+        return;
+    }
+    const RepositoryId repoId = state->repoId;
+    const QString repoPath = state->repoPath;
+    const QStringList tagsBefore = state->tagsBefore;
+    [[maybe_unused]] QFuture<void> future = QtConcurrent::run(m_gitPool, [this, repoId, repoPath, tagsBefore]() {
+        const QStringList tags = GitUtils::listTags(repoPath);
+        QMetaObject::invokeMethod(this, [this, repoId, tagsBefore, tags]() {
+            reportNewTags(repoId, tagsBefore, tags);
+        }, Qt::QueuedConnection);
+    });
 }
 
-void GitFetchWorker::checkForNewTags(const QString& repoName, const QString& repoPath, const QStringList& tagsBefore)
+void GitFetchWorker::reportNewTags(RepositoryId repoId, const QStringList& tagsBefore, const QStringList& tagsAfter)
 {
-    const QStringList tagsAfter = GitUtils::listTags(repoPath);
     if (tagsAfter.isEmpty()) {
         return;
     }
@@ -267,6 +703,6 @@ void GitFetchWorker::checkForNewTags(const QString& repoName, const QString& rep
         }
     }
     if (!newTags.isEmpty()) {
-        emit newTagsFound(repoName, newTags);
+        emit newTagsFound(repoId, newTags);
     }
 }
@@ -1,12 +1,47 @@
 #ifndef GITFETCHWORKER_H
 #define GITFETCHWORKER_H
 
+#include "fetchprogress.h"
 #include "gitmodels.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
 #include <QObject>
-#include <QThreadPool>
-#include <atomic>
+#include <QProcessEnvironment>
 #include <chrono>
+#include <memory>
 
+class QThreadPool;
+class QTimer;
+
+/** One remote's status transition, as batched by GitFetchWorker. */
+struct RemoteStatusUpdate {
+    RepositoryId repoId = 0;
+    QString remoteName;
+    FetchStatus status = FetchStatus::Ready;
+};
+Q_DECLARE_METATYPE(RemoteStatusUpdate)
+
+/** One remote's finished fetch (or probe), as recorded in the FetchJournal. */
+struct RemoteFetchRecord {
+    QString repoPath;
+    QString remoteName;
+    QString url;
+    qint64 startMs = 0;  // epoch-ms the fetch got a slot
+    qint64 endMs = 0;
+    qint64 bytes = -1;   // received, as reported by git; -1 if none was
+    FetchStatus outcome = FetchStatus::Ready;
+    int exitCode = -1;   // of the last git process; -1 if it was killed or never ran
+};
+Q_DECLARE_METATYPE(RemoteFetchRecord)
+
+/**
+ * Runs repository fetches on its own thread. Every remote is fetched by a
+ * `git` child process driven asynchronously through QProcess signals, so the
+ * number of remotes in flight is bounded by setMaxConcurrentFetches() rather
+ * than by threads blocked waiting on processes; the rest wait in a FIFO queue.
+ * All state is confined to the worker's thread: use queued invocations.
+ */
 class GitFetchWorker : public QObject
 {
     Q_OBJECT
@@ -17,41 +52,108 @@ public:
 
 public slots:
     void fetchRepository(const GitRepository& repo);
+    // Cancels queued remotes and kills running ones immediately.
     void stopFetching();
     void setTimeout(int timeoutSeconds);
     void setConnectionTimeout(int timeoutSeconds);
+    // When enabled, each remote's advertised refs are compared against the
+    // local tracking refs first and the fetch is skipped if nothing moved.
+    void setProbeBeforeFetch(bool enabled);
+    // Maximum number of remotes (git processes) being fetched at once.
+    void setMaxConcurrentFetches(int count);
 
 signals:
-    void fetchStarted(const QString& repoName);
-    void fetchProgress(const QString& repoName, const QString& remoteName, int progress);
+    void fetchStarted(RepositoryId repoId);
+    // Parsed `git fetch --progress` output for a remote, throttled to a few
+    // reports per second (every phase change and completion is reported).
+    void fetchProgress(RepositoryId repoId, const QString& remoteName, const FetchProgress& progress);
     // Per-remote lifecycle so the UI can show exactly which remote is in flight:
-    // status is one of "Queued", "Fetching...", "Success", "Error", "Timeout".
-    void remoteStatusChanged(const QString& repoName, const QString& remoteName, const QString& status);
-    void fetchFinished(const QString& repoName, bool success, const QString& message);
-    void fetchError(const QString& repoName, const QString& errorMessage);
-    void commitCountsUpdated(const QString& repoName, const QString& remoteName, int commitsAhead, int commitsBehind);
+    // Queued, Fetching, then Success, UpToDate, Error, Timeout or
+    // Cancelled. Transitions are delivered in order, in
+    // batches every 16 ms (a fetch wave makes thousands); pending ones always
+    // go out before any other signal about the same fetches.
+    void remoteStatusesChanged(const QList<RemoteStatusUpdate>& updates);
+    void fetchFinished(RepositoryId repoId, bool success, const QString& message);
+    void fetchError(RepositoryId repoId, const QString& errorMessage);
     // Emitted once per repository fetch when tags appeared that weren't present
     // before the fetch (regardless of which remote delivered them).
-    void newTagsFound(const QString& repoName, const QStringList& tags);
+    void newTagsFound(RepositoryId repoId, const QStringList& tags);
+    // Every remote fetch that ran, once it is over; one per git fetch, however
+    // many repository fetches were waiting on it.
+    void remoteFetchRecorded(const RemoteFetchRecord& record);
+    // Running total of fetches skipped because the probe found nothing new.
+    void probeSkipsChanged(int totalSkips);
 
 private:
-    // Fetch a single remote by shelling out to `git fetch`. ssh is allowed to
-    // prompt for a locked key's passphrase (no BatchMode), so this behaves like a
-    // manual fetch; mid-flight stalls are bounded at the transport layer (ssh
-    // ConnectTimeout + keepalives, http low-speed limits). The child process is
-    // killed if the overall deadline is exceeded or if a stop is requested.
-    // Emits the "Fetching..." transition; returns true on success and writes the
-    // resulting status label ("Success", "Error", "Timeout", "Cancelled").
-    bool fetchOneRemote(const QString& repoName, const QString& repoPath, const GitRemote& remote,
-                        std::chrono::steady_clock::time_point deadline, QString& statusLabel);
+    enum class RunOutcome { Succeeded, Failed, Cancelled, TimedOut };
+    enum class Stage { Probe, Fetch }; // `ls-remote` pre-check, then `fetch`
+    struct RepoFetchState;
+    struct RemoteJob;
+
+    // Environment / leading arguments for git commands that talk to a remote,
+    // with the transport-level stall bounds described at startStage.
+    QProcessEnvironment networkEnvironment() const;
+    QStringList networkGitArgs(const QString& repoPath, const QStringList& command) const;
+    // False if `ls-remote` output shows a branch that differs from its
+    // tracking ref. Otherwise a fetch would bring nothing in unless one of
+    // *tagObjects (objects of new or moved tags, "<sha>^{object}") exists
+    // locally; that lookup needs git, so it is left to the caller.
+    bool remoteMatchesLocal(const QString& repoPath, const GitRemote& remote, const QByteArray& advertised,
+                            QStringList* tagObjects) const;
+
+    // Queue a job per remote, or join one already in flight.
+    void queueRemotes(const std::shared_ptr<RepoFetchState>& state, const QList<GitRemote>& remotes);
+
+    // Start queued remote jobs while there are free slots.
+    void startQueuedJobs();
+    bool hasPendingWaiter(const RemoteJob& job) const;
+    // Launch the git process for one stage of a remote job. ssh is allowed to
+    // prompt for a locked key's passphrase (no BatchMode), so this behaves like
+    // a manual fetch; mid-flight stalls are bounded at the transport layer (ssh
+    // ConnectTimeout + keepalives, http low-speed limits). The process is
+    // killed when the job's deadline passes or a stop is requested.
+    void startStage(const std::shared_ptr<RemoteJob>& job, Stage stage);
+    // Forward parsed progress from a job's fetch stage to its waiters.
+    void reportProgress(const std::shared_ptr<RemoteJob>& job, const QList<FetchProgress>& reports);
+    // Move a job on after its process ended: probe -> fetch or skip, or done.
+    void onStageFinished(const std::shared_ptr<RemoteJob>& job, RunOutcome outcome);
+    // The probe found nothing new: count the skip and report UpToDate.
+    void skipFetch(const std::shared_ptr<RemoteJob>& job);
+    // Free the job's slot and report the result (Success, UpToDate, Error,
+    // Timeout or Cancelled) to every waiter.
+    void finishJob(const std::shared_ptr<RemoteJob>& job, bool ok, FetchStatus status);
     // Diff the repository's current tags against the pre-fetch snapshot and emit
-    // newTagsFound for any that appeared.
-    void checkForNewTags(const QString& repoName, const QString& repoPath, const QStringList& tagsBefore);
+    // newTagsFound for any that appeared. Tags are read from the ref files;
+    // where only `git tag` can list them it runs on the thread pool.
+    void checkForNewTags(const std::shared_ptr<RepoFetchState>& state);
+    void reportNewTags(RepositoryId repoId, const QStringList& tagsBefore, const QStringList& tagsAfter);
+    // Record one remote's result against a repository fetch (one waiter of an
+    // in-flight remote) and finalize the repository once all remotes are in.
+    void completeRemote(const std::shared_ptr<RepoFetchState>& state, const QString& remoteName,
+                        bool ok, FetchStatus status);
+    void queueRemoteStatus(RepositoryId repoId, const QString& remoteName, FetchStatus status);
+    // Emit the batched status transitions now.
+    void flushRemoteStatuses();
+
+    int m_timeoutSeconds;
+    int m_connectionTimeoutSeconds; // ssh ConnectTimeout / keepalive interval
+    bool m_probeFirst;  // ls-remote before fetching, skip if unchanged
+    int m_probeSkips;   // fetches skipped by the probe this session
+    int m_maxConcurrent; // remote jobs allowed to run at once
+    int m_running;       // remote jobs currently holding a slot
+
+    QList<std::shared_ptr<RemoteJob>> m_queue; // waiting for a free slot, FIFO
+    // Queued or running remote jobs keyed by shared git dir + remote name (see
+    // inFlightKey), so duplicate requests join instead of refetching.
+    QHash<QString, std::shared_ptr<RemoteJob>> m_inFlight;
+    // Repository fetches whose tag snapshot is still being taken by `git tag`.
+    QList<std::shared_ptr<RepoFetchState>> m_awaitingTags;
 
-    QThreadPool m_pool; // bounded pool so independent remote fetches run concurrently
-    std::atomic<bool> m_stopRequested;
-    std::atomic<int> m_timeoutSeconds;
-    std::atomic<int> m_connectionTimeoutSeconds; // ssh ConnectTimeout / keepalive interval
+    QList<RemoteStatusUpdate> m_pendingStatuses; // not yet emitted, in order
+    QTimer *m_statusFlushTimer;
+    // Runs the git commands this thread must not wait on (`git tag`, tag
+    // object lookups); drained in the destructor.
+    QThreadPool *m_gitPool;
 };
 
 #endif // GITFETCHWORKER_H
@@ -1,11 +1,34 @@
 #include "gitmodels.h"
 
+QString fetchStatusText(FetchStatus status)
+{
+    switch (status) {
+    case FetchStatus::Ready:
+        return QStringLiteral("Ready");
+    case FetchStatus::Queued:
+        return QStringLiteral("Queued");
+    case FetchStatus::Fetching:
+        return QStringLiteral("Fetching...");
+    case FetchStatus::Success:
+        return QStringLiteral("Success");
+    case FetchStatus::UpToDate:
+        return QStringLiteral("Up to date (probed)");
+    case FetchStatus::Error:
+        return QStringLiteral("Error");
+    case FetchStatus::Timeout:
+        return QStringLiteral("Timeout");
+    case FetchStatus::Cancelled:
+        return QStringLiteral("Cancelled");
+    }
+    return QString();
+}
+
 QJsonObject GitRemote::toJson() const {
     QJsonObject obj;
     obj["name"] = name;
     obj["url"] = url;
-    // Note: `status` and `lastFetch` are transient session-only state and are
-    // deliberately NOT persisted. Interval-based fetching is relative to app start.
+    // Note: `status` and `lastFetch` change with every fetch and are kept in
+    // runtime-state.json (RuntimeState) instead, so fetching never rewrites the config.
     // Note: commitsAhead and commitsBehind are NOT saved - they are always calculated from the git repo
     return obj;
 }
@@ -14,9 +37,9 @@ GitRemote GitRemote::fromJson(const QJsonObject& obj) {
     GitRemote remote;
     remote.name = obj["name"].toString();
     remote.url = obj["url"].toString();
-    // `status` and `lastFetch` are intentionally not read back: they are
-    // runtime-only state. Any values left in older config files are ignored so
-    // the remote starts each session fresh.
+    // `status` and `lastFetch` are intentionally not read back: FetchCore
+    // restores them from runtime-state.json. Any values left in older config
+    // files are ignored.
     // Note: commitsAhead and commitsBehind are NOT loaded - they are always calculated from the git repo
     // They default to 0 in the constructor and will be recalculated after loading
     return remote;
@@ -29,8 +52,7 @@ QJsonObject GitRepository::toJson() const {
     obj["branch"] = branch;
     obj["fetchInterval"] = fetchInterval;
     obj["enabled"] = enabled;
-    // `status` and `lastFetch` are transient session-only state and are
-    // deliberately not persisted.
+    // `status` and `lastFetch` live in runtime-state.json, not here.
 
     QJsonArray remotesArray;
     for (const GitRemote& remote : remotes) {
@@ -7,6 +7,44 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonValue>
+#include <QtGlobal>
+
+/**
+ * Runtime identity of a tracked repository. Names aren't unique (two clones
+ * can share a directory name), so everything that refers to a repository
+ * across components - worker signals, scheduler, planner, watcher, tree model
+ * - uses this instead.
+ */
+using RepositoryId = quint64;
+
+/**
+ * Fetch state of a remote or repository. Compared on every paint and every
+ * status transition, so it is an enum rather than its display text; use
+ * fetchStatusText() wherever it is shown or sent to clients.
+ */
+enum class FetchStatus : quint8 {
+    Ready,     // never fetched, or nothing recorded since
+    Queued,
+    Fetching,
+    Success,
+    UpToDate,  // probe found nothing new, fetch skipped
+    Error,
+    Timeout,
+    Cancelled,
+};
+
+/** "Ready", "Queued", "Fetching...", "Success", "Up to date (probed)", ... */
+QString fetchStatusText(FetchStatus status);
+
+/**
+ * Severity of an activity-log message, chosen by whoever logs it so that
+ * filtering never depends on the message's wording.
+ */
+enum class LogLevel : quint8 {
+    Info,
+    Warning,
+    Error,
+};
 
 /**
  * Represents a Git remote with its status and commit differences
@@ -15,12 +53,16 @@ struct GitRemote {
     QString name;
     QString url;
     QString lastFetch;
-    QString status;
+    FetchStatus status = FetchStatus::Ready;
     int commitsAhead;
     int commitsBehind;
-    // Transient: epoch-ms when this remote entered the "Fetching..." state, used
+    // Transient: epoch-ms when this remote entered the Fetching state, used
     // to render a live elapsed counter. Not persisted to JSON.
     qint64 fetchStartMs = 0;
+    // Transient: latest parsed progress of the running fetch ("Receiving
+    // objects 45%, 1.2 MiB, 600 KiB/s") and the bytes received so far.
+    QString progressText;
+    qint64 bytesReceived = 0;
 
     GitRemote() : commitsAhead(0), commitsBehind(0) {}
 
@@ -32,13 +74,16 @@ struct GitRemote {
  * Represents a Git repository with its configuration and remotes
  */
 struct GitRepository {
+    // Assigned by FetchCore when the repository starts being tracked, never
+    // reused within a session; 0 until then. Not persisted.
+    RepositoryId id = 0;
     QString name;
     QString localPath;
     QString branch;
     int fetchInterval; // in minutes
     bool enabled;
     QString lastFetch;
-    QString status;
+    FetchStatus status = FetchStatus::Ready;
     QList<GitRemote> remotes;
     QStringList worktrees; // List of worktree paths
 
@@ -0,0 +1,226 @@
+#include "gitrefdb.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <memory>
+
+namespace GitRefDb {
+
+namespace {
+constexpr int kMaxSymrefDepth = 5; // same bound git uses for symref chains
+
+QString firstLine(const QString& filePath)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    return QString::fromUtf8(f.readLine()).trimmed();
+}
+
+// Parsed packed-refs file, shared between callers and revalidated on access.
+struct PackedRefs {
+    qint64 mtimeMs = -1;
+    qint64 size = -1;
+    QHash<QString, QString> refs; // refname -> object name (peeled lines skipped)
+};
+
+QMutex g_packedMutex;
+QHash<QString, std::shared_ptr<const PackedRefs>> g_packedCache; // keyed by file path
+
+std::shared_ptr<const PackedRefs> packedRefs(const GitDirs& dirs)
+{
+    const QString path = dirs.commonDir + QStringLiteral("/packed-refs");
+    const QFileInfo fi(path);
+    if (!fi.exists()) {
+        QMutexLocker lock(&g_packedMutex);
+        g_packedCache.remove(path);
+        return std::make_shared<const PackedRefs>();
+    }
+    const qint64 mtimeMs = fi.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fi.size();
+
+    {
+        QMutexLocker lock(&g_packedMutex);
+        const auto it = g_packedCache.constFind(path);
+        if (it != g_packedCache.constEnd() && it.value()->mtimeMs == mtimeMs && it.value()->size == size) {
+            return it.value();
+        }
+    }
+
+    // Parse outside the lock; a concurrent reparse of the same file is harmless.
+    auto parsed = std::make_shared<PackedRefs>();
+    parsed->mtimeMs = mtimeMs;
+    parsed->size = size;
+    QFile f(path);
+    if (f.open(QIODevice::ReadOnly)) {
+        while (!f.atEnd()) {
+            const QByteArray line = f.readLine().trimmed();
+            // "# pack-refs with: ..." header and "^<peeled>" lines carry no refs.
+            if (line.isEmpty() || line.startsWith('#') || line.startsWith('^')) {
+                continue;
+            }
+            const int space = line.indexOf(' ');
+            if (space <= 0) {
+                continue;
+            }
+            parsed->refs.insert(QString::fromUtf8(line.mid(space + 1)),
+                                QString::fromLatin1(line.left(space)));
+        }
+    }
+
+    QMutexLocker lock(&g_packedMutex);
+    g_packedCache.insert(path, parsed);
+    return parsed;
+}
+
+// Reject names that could escape the git directory.
+bool isSafeRefName(const QString& refName)
+{
+    return !refName.isEmpty() && !refName.contains(QStringLiteral(".."))
+           && !refName.startsWith(QLatin1Char('/')) && !refName.contains(QLatin1Char('\\'));
+}
+
+// HEAD (and the other per-worktree pseudo refs) live in gitDir; everything
+// under refs/ except refs/worktree and refs/bisect is shared.
+QString looseRefPath(const GitDirs& dirs, const QString& refName)
+{
+    const bool perWorktree = !refName.startsWith(QStringLiteral("refs/"))
+                             || refName.startsWith(QStringLiteral("refs/worktree/"))
+                             || refName.startsWith(QStringLiteral("refs/bisect/"));
+    return (perWorktree ? dirs.gitDir : dirs.commonDir) + QLatin1Char('/') + refName;
+}
+
+// Read a ref without following it: either an object name or "ref: <target>".
+QString readRawRef(const GitDirs& dirs, const QString& refName)
+{
+    const QString loosePath = looseRefPath(dirs, refName);
+    if (QFileInfo(loosePath).isFile()) {
+        return firstLine(loosePath);
+    }
+    return packedRefs(dirs)->refs.value(refName);
+}
+} // namespace
+
+GitDirs resolveGitDirs(const QString& localPath)
+{
+    GitDirs dirs;
+    const QString dotGit = localPath + QStringLiteral("/.git");
+    QFileInfo fi(dotGit);
+
+    if (fi.isDir()) {
+        dirs.gitDir = dotGit;
+        dirs.commonDir = dotGit;
+        dirs.valid = true;
+        return dirs;
+    }
+
+    if (fi.isFile()) {
+        // Worktree: ".git" is a file containing "gitdir: <path>".
+        const QString line = firstLine(dotGit);
+        const QString marker = QStringLiteral("gitdir:");
+        if (line.startsWith(marker)) {
+            QString gd = line.mid(marker.size()).trimmed();
+            if (QDir::isRelativePath(gd)) {
+                gd = QDir(localPath).absoluteFilePath(gd);
+            }
+            dirs.gitDir = QDir(gd).absolutePath();
+
+            // The shared dir is named in <gitDir>/commondir, else it's gitDir.
+            const QString commonFile = dirs.gitDir + QStringLiteral("/commondir");
+            if (QFileInfo::exists(commonFile)) {
+                QString cd = firstLine(commonFile);
+                if (QDir::isRelativePath(cd)) {
+                    cd = QDir(dirs.gitDir).absoluteFilePath(cd);
+                }
+                dirs.commonDir = QDir(cd).absolutePath();
+            } else {
+                dirs.commonDir = dirs.gitDir;
+            }
+            dirs.valid = true;
+        }
+    }
+
+    return dirs;
+}
+
+bool isSupported(const GitDirs& dirs)
+{
+    return dirs.valid && !QFileInfo(dirs.commonDir + QStringLiteral("/reftable")).isDir();
+}
+
+QString resolve(const GitDirs& dirs, const QString& refName)
+{
+    if (!isSupported(dirs)) {
+        return QString();
+    }
+
+    QString name = refName;
+    for (int depth = 0; depth < kMaxSymrefDepth; ++depth) {
+        if (!isSafeRefName(name)) {
+            return QString();
+        }
+        const QString raw = readRawRef(dirs, name);
+        if (raw.startsWith(QStringLiteral("ref:"))) {
+            name = raw.mid(4).trimmed();
+            continue;
+        }
+        return raw;
+    }
+    return QString(); // symref loop
+}
+
+QString currentBranch(const GitDirs& dirs)
+{
+    if (!isSupported(dirs)) {
+        return QString();
+    }
+    const QString head = firstLine(dirs.gitDir + QStringLiteral("/HEAD"));
+    const QString prefix = QStringLiteral("ref: refs/heads/");
+    if (!head.startsWith(prefix)) {
+        return QString(); // detached
+    }
+    return head.mid(prefix.size()).trimmed();
+}
+
+QMap<QString, QString> listRefs(const GitDirs& dirs, const QString& prefix)
+{
+    QMap<QString, QString> refs;
+    if (!isSupported(dirs) || !isSafeRefName(prefix)) {
+        return refs;
+    }
+
+    const auto packed = packedRefs(dirs);
+    for (auto it = packed->refs.constBegin(); it != packed->refs.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            refs.insert(it.key(), it.value());
+        }
+    }
+
+    // Loose refs take precedence over packed ones.
+    const QString root = dirs.commonDir + QLatin1Char('/') + prefix;
+    if (QFileInfo(root).isDir()) {
+        const QDir commonDir(dirs.commonDir);
+        QDirIterator it(root, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString path = it.next();
+            if (path.endsWith(QStringLiteral(".lock"))) {
+                continue; // in-progress ref update
+            }
+            const QString value = firstLine(path);
+            if (value.isEmpty() || value.startsWith(QStringLiteral("ref:"))) {
+                continue;
+            }
+            refs.insert(commonDir.relativeFilePath(path), value);
+        }
+    }
+
+    return refs;
+}
+
+} // namespace GitRefDb
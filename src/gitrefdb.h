@@ -0,0 +1,56 @@
+#ifndef GITREFDB_H
+#define GITREFDB_H
+
+#include <QMap>
+#include <QString>
+
+/**
+ * In-process reader for the files-backend ref database, so the common
+ * ref questions (current branch, ref -> object name) are answered by reading
+ * `HEAD`, loose refs and `packed-refs` directly instead of spawning git.
+ * Configuration (upstreams, remotes) is read by GitConfig.
+ *
+ * Everything here is read-only and thread-safe. Parsed packed-refs files are
+ * cached and revalidated against the file's mtime and size. Repositories using
+ * a ref backend this reader doesn't understand (reftable) report
+ * isSupported() == false; callers should fall back to git for those.
+ */
+namespace GitRefDb {
+
+/**
+ * Git directories for a working tree. For a normal repository both point at
+ * "<path>/.git"; for a linked worktree gitDir is the per-worktree directory
+ * (holding HEAD) and commonDir the shared one (refs/heads, refs/remotes,
+ * packed-refs, config).
+ */
+struct GitDirs {
+    QString gitDir;
+    QString commonDir;
+    bool valid = false;
+};
+
+/** Resolve the git directories of a working tree (handles worktree gitdir/commondir). */
+GitDirs resolveGitDirs(const QString& localPath);
+
+/** True if the repository's ref storage can be read by this module. */
+bool isSupported(const GitDirs& dirs);
+
+/**
+ * Resolve a fully-qualified ref ("refs/heads/main", "refs/remotes/origin/main")
+ * or "HEAD" to its object name, following symbolic refs. Returns an empty
+ * string if the ref doesn't exist.
+ */
+QString resolve(const GitDirs& dirs, const QString& refName);
+
+/** Short name of the checked-out branch, or empty if HEAD is detached/unreadable. */
+QString currentBranch(const GitDirs& dirs);
+
+/**
+ * All refs under the given prefix (e.g. "refs/remotes/origin/"), loose and
+ * packed, mapped to their object names. Symbolic refs are skipped.
+ */
+QMap<QString, QString> listRefs(const GitDirs& dirs, const QString& prefix);
+
+} // namespace GitRefDb
+
+#endif // GITREFDB_H
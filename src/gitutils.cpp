@@ -1,12 +1,19 @@
 #include "gitutils.h"
+#include "commitcountcache.h"
+#include "gitbatchpool.h"
+#include "gitconfig.h"
+#include "gitrefdb.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QPair>
 #include <QProcess>
 #include <QProcessEnvironment>
 #include <QRegularExpression>
+#include <QSet>
 #include <QTextStream>
 #include <QDebug>
 
@@ -118,6 +125,48 @@ GitResult runGit(const QString& workingDir, const QStringList& args, int timeout
     return result;
 }
 
+QStringList resolveRefs(const QString& repoPath, const QStringList& revisions) {
+    QStringList objectNames;
+
+    // Plain ref names are answered straight from the ref files. Anything else
+    // (revision expressions, or a ref backend GitRefDb can't read) goes to git.
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(repoPath);
+    if (GitRefDb::isSupported(dirs)) {
+        bool allRefNames = true;
+        for (const QString& rev : revisions) {
+            if (rev != QStringLiteral("HEAD") && !rev.startsWith(QStringLiteral("refs/"))) {
+                allRefNames = false;
+                break;
+            }
+        }
+        if (allRefNames) {
+            objectNames.reserve(revisions.size());
+            for (const QString& rev : revisions) {
+                objectNames.append(GitRefDb::resolve(dirs, rev));
+            }
+            return objectNames;
+        }
+    }
+
+    if (GitBatchPool::forCurrentThread().resolve(repoPath, revisions, objectNames)) {
+        return objectNames;
+    }
+
+    // Co-process unavailable: resolve one at a time the old way.
+    objectNames.clear();
+    for (const QString& rev : revisions) {
+        const GitResult res = runGit(repoPath,
+            {QStringLiteral("rev-parse"), QStringLiteral("--verify"), QStringLiteral("--quiet"), rev}, 10000);
+        objectNames.append(res.ok() ? res.stdOut.trimmed() : QString());
+    }
+    return objectNames;
+}
+
+QString resolveRef(const QString& repoPath, const QString& revision) {
+    const QStringList resolved = resolveRefs(repoPath, {revision});
+    return resolved.isEmpty() ? QString() : resolved.first();
+}
+
 bool isRepositoryValid(const QString& path) {
     return isGitRepository(path) || isGitWorktree(path);
 }
@@ -215,49 +264,39 @@ QStringList findWorktreesForRepository(const QString& mainRepoPath) {
     return worktrees;
 }
 
-QStringList findGitRepositories(const QString& directoryPath, const QStringList& excludeDirs) {
-    QStringList repositories;
-    QDir dir(directoryPath);
-
-    if (!dir.exists()) {
-        return repositories;
-    }
-
+namespace {
+void collectGitRepositories(const QString& directoryPath, const QStringList& excludeDirs,
+                            QStringList& repositories, QSet<QString>& seen) {
     // Check if current directory is a git repository or worktree
     if (isGitRepository(directoryPath) || isGitWorktree(directoryPath)) {
-        // Find the main repository path to avoid duplicates
-        QString mainRepoPath = findMainGitRepository(directoryPath);
-        
-        // Only add if we haven't seen this main repository before
-        if (!repositories.contains(mainRepoPath)) {
+        // Report the main repository, once, however many worktrees lead to it
+        const QString mainRepoPath = findMainGitRepository(directoryPath);
+        if (!seen.contains(mainRepoPath)) {
+            seen.insert(mainRepoPath);
             repositories.append(mainRepoPath);
         }
-        return repositories; // Don't recurse into subdirectories of a git repo
+        return; // Don't recurse into subdirectories of a git repo
     }
 
     // Get all subdirectories
-    QFileInfoList entries = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-
+    const QFileInfoList entries = QDir(directoryPath).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
     for (const QFileInfo& entry : entries) {
-        QString subDirPath = entry.absoluteFilePath();
-        QString dirName = entry.fileName();
-
         // Skip excluded directories
-        if (excludeDirs.contains(dirName, Qt::CaseInsensitive)) {
+        if (excludeDirs.contains(entry.fileName(), Qt::CaseInsensitive)) {
             continue;
         }
-
-        // Recursively search subdirectories
-        QStringList subRepos = findGitRepositories(subDirPath, excludeDirs);
-        
-        // Add unique repositories only
-        for (const QString& repo : subRepos) {
-            if (!repositories.contains(repo)) {
-                repositories.append(repo);
-            }
-        }
+        collectGitRepositories(entry.absoluteFilePath(), excludeDirs, repositories, seen);
     }
+}
+} // namespace
 
+QStringList findGitRepositories(const QString& directoryPath, const QStringList& excludeDirs) {
+    QStringList repositories;
+    if (!QDir(directoryPath).exists()) {
+        return repositories;
+    }
+    QSet<QString> seen;
+    collectGitRepositories(directoryPath, excludeDirs, repositories, seen);
     return repositories;
 }
 
@@ -269,36 +308,28 @@ QString getRepositoryName(const QString& path) {
 QList<GitRemote> getRepositoryRemotes(const QString& path) {
     QList<GitRemote> remotes;
 
-    const GitResult listed = runGit(path, {QStringLiteral("remote")}, 10000);
-    if (!listed.ok()) {
-        return remotes;
-    }
-
-    const QStringList names = listed.stdOut.split('\n', Qt::SkipEmptyParts);
-    for (const QString& rawName : names) {
-        const QString name = rawName.trimmed();
-        if (name.isEmpty()) {
-            continue;
-        }
-
-        const GitResult url = runGit(path, {QStringLiteral("remote"), QStringLiteral("get-url"), name}, 10000);
-        if (!url.ok()) {
-            continue;
-        }
-
+    // Read from the config files in-process: remotes in config order, with
+    // url.<base>.insteadOf applied, just as `git remote get-url` reports them.
+    const GitConfig::Config config = GitConfig::load(GitRefDb::resolveGitDirs(path));
+    const QList<GitConfig::Remote> configured = GitConfig::remotes(config);
+    for (const GitConfig::Remote& remote : configured) {
         GitRemote gitRemote;
-        gitRemote.name = name;
-        gitRemote.url = url.stdOut.trimmed();
-        gitRemote.status = QStringLiteral("Ready");
-        if (!gitRemote.url.isEmpty()) {
-            remotes.append(gitRemote);
-        }
+        gitRemote.name = remote.name;
+        gitRemote.url = remote.url;
+        gitRemote.status = FetchStatus::Ready;
+        remotes.append(gitRemote);
     }
 
     return remotes;
 }
 
 QString getRepositoryBranch(const QString& path) {
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(path);
+    if (GitRefDb::isSupported(dirs)) {
+        const QString branch = GitRefDb::currentBranch(dirs);
+        return branch.isEmpty() ? QStringLiteral("main") : branch; // Default / detached HEAD
+    }
+
     const GitResult res = runGit(path, {QStringLiteral("rev-parse"), QStringLiteral("--abbrev-ref"), QStringLiteral("HEAD")}, 10000);
     if (res.ok()) {
         const QString branch = res.stdOut.trimmed();
@@ -309,60 +340,219 @@ QString getRepositoryBranch(const QString& path) {
     return QStringLiteral("main"); // Default / detached HEAD
 }
 
-void calculateRemoteCommitCounts(const QString& repoPath, GitRemote& remote, const QString& branch, const QString& repoName) {
-    Q_UNUSED(repoName);
+namespace {
+// `%(ahead-behind:<base>)` in for-each-ref needs git 2.41+. Probed once.
+bool gitHasAheadBehindAtom() {
+    static QMutex mutex;
+    static int supported = -1;
 
-    remote.commitsAhead = 0;
-    remote.commitsBehind = 0;
+    QMutexLocker lock(&mutex);
+    if (supported < 0) {
+        supported = 0;
+        const GitResult res = runGit(QString(), {QStringLiteral("version")}, 10000);
+        const QRegularExpressionMatch m =
+            QRegularExpression(QStringLiteral("(\\d+)\\.(\\d+)")).match(res.stdOut);
+        if (res.ok() && m.hasMatch()) {
+            const int major = m.captured(1).toInt();
+            const int minor = m.captured(2).toInt();
+            supported = (major > 2 || (major == 2 && minor >= 41)) ? 1 : 0;
+        }
+    }
+    return supported == 1;
+}
+
+// Parse "<a> <b>" as printed by rev-list --count and %(ahead-behind:...).
+bool parseCountPair(const QString& text, int& first, int& second) {
+    const QStringList parts = text.trimmed().split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+    if (parts.size() != 2) {
+        return false;
+    }
+    first = parts[0].toInt();
+    second = parts[1].toInt();
+    return true;
+}
+
+// Resolve the local tip and, per remote, the tracking ref to compare against
+// and its tip. Remotes whose tip equals the local one are already final (0/0).
+QList<RemoteCommitCounts> resolveTrackingTips(const QString& repoPath, const QString& branch,
+                                              const QStringList& remoteNames) {
+    QList<RemoteCommitCounts> results;
+    results.reserve(remoteNames.size());
+    for (const QString& name : remoteNames) {
+        RemoteCommitCounts counts;
+        counts.remoteName = name;
+        results.append(counts);
+    }
+    if (remoteNames.isEmpty()) {
+        return results;
+    }
 
-    // Resolve the local branch ref; fall back to HEAD if the named branch
-    // doesn't exist locally.
-    QString localRef = QStringLiteral("refs/heads/%1").arg(branch);
-    if (!runGit(repoPath, {QStringLiteral("rev-parse"), QStringLiteral("--verify"), QStringLiteral("--quiet"), localRef}, 10000).ok()) {
-        localRef = QStringLiteral("HEAD");
+    // Read the branch's upstream and the remotes' fetch refspecs once for the
+    // whole repository, straight from its config.
+    const GitConfig::Config config = GitConfig::load(GitRefDb::resolveGitDirs(repoPath));
+    QString upstreamRemote, mergeRef;
+    if (!GitConfig::branchUpstream(config, branch, upstreamRemote, mergeRef)) {
+        upstreamRemote.clear();
+    }
+    QHash<QString, QStringList> fetchRefspecs;
+    const QList<GitConfig::Remote> configuredRemotes = GitConfig::remotes(config);
+    for (const GitConfig::Remote& remote : configuredRemotes) {
+        fetchRefspecs.insert(remote.name, remote.fetchRefspecs);
     }
 
-    // Determine which remote-tracking ref to compare against.
+    // Where a fetch from `name` stores one of its branches: as the remote's
+    // refspecs say, else the default refs/remotes/<name>/<branch> layout.
+    const QString headsPrefix = QStringLiteral("refs/heads/");
+    const auto trackingRefFor = [&](const QString& name, const QString& remoteRef) {
+        const QString mapped = GitConfig::trackingRef(fetchRefspecs.value(name), remoteRef);
+        if (!mapped.isEmpty() || !remoteRef.startsWith(headsPrefix)) {
+            return mapped;
+        }
+        return QStringLiteral("refs/remotes/%1/%2").arg(name, remoteRef.mid(headsPrefix.size()));
+    };
+
+    // Determine which remote-tracking ref to compare against, per remote:
     //  1. Prefer the configured upstream, but only if it belongs to THIS remote
     //     (comparing against an unrelated remote produces misleading counts).
     //  2. Otherwise use the same-named branch on this remote, if present.
     //  3. Otherwise there's nothing meaningful to compare -> 0/0.
-    QString remoteRef;
-    const GitResult upstream = runGit(repoPath,
-        {QStringLiteral("rev-parse"), QStringLiteral("--abbrev-ref"), QStringLiteral("--symbolic-full-name"),
-         QStringLiteral("%1@{upstream}").arg(branch)}, 10000);
-    if (upstream.ok()) {
-        const QString up = upstream.stdOut.trimmed();
-        if (up.startsWith(remote.name + QStringLiteral("/"))) {
-            remoteRef = QStringLiteral("refs/remotes/%1").arg(up);
+    // Both candidates for every remote, plus the local branch and HEAD (used
+    // if the named branch doesn't exist locally), resolve in one batch.
+    QStringList revisions = {QStringLiteral("refs/heads/%1").arg(branch), QStringLiteral("HEAD")};
+    for (const QString& name : remoteNames) {
+        const QString preferred = (upstreamRemote == name) ? trackingRefFor(name, mergeRef) : QString();
+        const QString sameNamed = trackingRefFor(name, headsPrefix + branch);
+        revisions << (preferred.isEmpty() ? sameNamed : preferred) << sameNamed;
+    }
+
+    const QStringList resolved = resolveRefs(repoPath, revisions);
+    if (resolved.size() != revisions.size()) {
+        return results;
+    }
+    const QString localSha = !resolved[0].isEmpty() ? resolved[0] : resolved[1];
+    if (localSha.isEmpty()) {
+        return results;
+    }
+
+    for (int i = 0; i < results.size(); ++i) {
+        RemoteCommitCounts& counts = results[i];
+        const int preferredAt = 2 + i * 2;
+        const int sameNamedAt = preferredAt + 1;
+        const int chosenAt = !resolved[preferredAt].isEmpty() ? preferredAt : sameNamedAt;
+        counts.localSha = localSha;
+        counts.remoteSha = resolved[chosenAt];
+        if (counts.remoteSha.isEmpty()) {
+            continue; // no corresponding remote branch
         }
+        counts.remoteRef = revisions[chosenAt];
+        counts.valid = (counts.remoteSha == localSha); // identical tips: nothing to walk
     }
+    return results;
+}
+} // namespace
 
-    if (remoteRef.isEmpty()) {
-        const QString candidate = QStringLiteral("refs/remotes/%1/%2").arg(remote.name, branch);
-        if (runGit(repoPath, {QStringLiteral("rev-parse"), QStringLiteral("--verify"), QStringLiteral("--quiet"), candidate}, 10000).ok()) {
-            remoteRef = candidate;
+QList<RemoteCommitCounts> cachedRemoteCommitCounts(const QString& repoPath, const QString& branch,
+                                                   const QStringList& remoteNames, CommitCountCache& cache) {
+    QList<RemoteCommitCounts> results = resolveTrackingTips(repoPath, branch, remoteNames);
+    for (RemoteCommitCounts& counts : results) {
+        if (!counts.valid && cache.lookup(counts.localSha, counts.remoteSha, counts.ahead, counts.behind)) {
+            counts.valid = true;
         }
     }
+    return results;
+}
+
+QList<RemoteCommitCounts> calculateAllRemoteCommitCounts(const QString& repoPath, const QString& branch,
+                                                         const QStringList& remoteNames, CommitCountCache* cache) {
+    QList<RemoteCommitCounts> results = resolveTrackingTips(repoPath, branch, remoteNames);
 
-    if (remoteRef.isEmpty()) {
-        return; // no corresponding remote branch
+    // Anything not settled by identical tips or a cached pair needs a walk.
+    QStringList pendingRefs;
+    for (RemoteCommitCounts& counts : results) {
+        if (counts.valid || counts.remoteSha.isEmpty()) {
+            continue;
+        }
+        if (cache && cache->lookup(counts.localSha, counts.remoteSha, counts.ahead, counts.behind)) {
+            counts.valid = true;
+        } else if (!pendingRefs.contains(counts.remoteRef)) {
+            pendingRefs.append(counts.remoteRef);
+        }
+    }
+    if (pendingRefs.isEmpty()) {
+        return results;
+    }
+    const QString localSha = results.first().localSha;
+
+    // Newer git answers every remote in one walk. %(ahead-behind:<base>) is
+    // reported from the listed ref's point of view, so a remote ref that is
+    // "ahead" of the local branch means the local branch is behind it.
+    if (gitHasAheadBehindAtom()) {
+        QStringList args = {QStringLiteral("for-each-ref"),
+                            QStringLiteral("--format=%(refname)%09%(ahead-behind:%1)").arg(localSha)};
+        args += pendingRefs;
+        const GitResult batch = runGit(repoPath, args, 15000);
+        if (batch.ok()) {
+            QHash<QString, QPair<int, int>> byRef;
+            const QStringList lines = batch.stdOut.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+            for (const QString& line : lines) {
+                const int tab = line.indexOf(QLatin1Char('\t'));
+                int refAhead = 0, refBehind = 0;
+                if (tab > 0 && parseCountPair(line.mid(tab + 1), refAhead, refBehind)) {
+                    byRef.insert(line.left(tab), qMakePair(refAhead, refBehind));
+                }
+            }
+            for (RemoteCommitCounts& counts : results) {
+                const auto it = byRef.constFind(counts.remoteRef);
+                if (!counts.valid && it != byRef.constEnd()) {
+                    counts.ahead = it.value().second;
+                    counts.behind = it.value().first;
+                    counts.valid = true;
+                }
+            }
+        }
     }
 
-    // `git rev-list --left-right --count A...B` prints "<ahead> <behind>" where
-    // ahead = commits in A not B and behind = commits in B not A.
-    const GitResult counts = runGit(repoPath,
-        {QStringLiteral("rev-list"), QStringLiteral("--left-right"), QStringLiteral("--count"),
-         QStringLiteral("%1...%2").arg(localRef, remoteRef)}, 15000);
-    if (!counts.ok()) {
-        return;
+    // Whatever is still open (older git, or for-each-ref failed) falls back to
+    // one `git rev-list --left-right --count A...B` per distinct remote tip. It
+    // prints "<ahead> <behind>" where ahead = commits in A not B and behind =
+    // commits in B not A.
+    QHash<QString, QPair<int, int>> bySha;
+    for (RemoteCommitCounts& counts : results) {
+        if (counts.valid || counts.remoteSha.isEmpty()) {
+            continue;
+        }
+        auto it = bySha.constFind(counts.remoteSha);
+        if (it == bySha.constEnd()) {
+            const GitResult walk = runGit(repoPath,
+                {QStringLiteral("rev-list"), QStringLiteral("--left-right"), QStringLiteral("--count"),
+                 QStringLiteral("%1...%2").arg(localSha, counts.remoteSha)}, 15000);
+            int ahead = 0, behind = 0;
+            if (!walk.ok() || !parseCountPair(walk.stdOut, ahead, behind)) {
+                continue;
+            }
+            it = bySha.insert(counts.remoteSha, qMakePair(ahead, behind));
+        }
+        counts.ahead = it.value().first;
+        counts.behind = it.value().second;
+        counts.valid = true;
     }
 
-    const QStringList parts = counts.stdOut.trimmed().split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
-    if (parts.size() == 2) {
-        remote.commitsAhead = parts[0].toInt();
-        remote.commitsBehind = parts[1].toInt();
+    if (cache) {
+        for (const RemoteCommitCounts& counts : results) {
+            if (counts.valid && pendingRefs.contains(counts.remoteRef)) {
+                cache->insert(counts.localSha, counts.remoteSha, counts.ahead, counts.behind);
+            }
+        }
     }
+    return results;
+}
+
+void calculateRemoteCommitCounts(const QString& repoPath, GitRemote& remote, const QString& branch, const QString& repoName) {
+    Q_UNUSED(repoName);
+
+    const QList<RemoteCommitCounts> counts = calculateAllRemoteCommitCounts(repoPath, branch, {remote.name});
+    remote.commitsAhead = counts.isEmpty() ? 0 : counts.first().ahead;
+    remote.commitsBehind = counts.isEmpty() ? 0 : counts.first().behind;
 }
 
 QStringList listTags(const QString& repoPath) {
@@ -374,28 +564,39 @@ QStringList listTags(const QString& repoPath) {
 }
 
 bool canFastForward(const QString& repoPath, const QString& branch, const QString& remoteName) {
-    const QString localRef = QStringLiteral("refs/heads/%1").arg(branch);
-    const QString remoteRef = QStringLiteral("refs/remotes/%1/%2").arg(remoteName, branch);
+    const QStringList resolved = resolveRefs(repoPath,
+        {QStringLiteral("refs/heads/%1").arg(branch), QStringLiteral("refs/remotes/%1/%2").arg(remoteName, branch)});
+    if (resolved.size() != 2 || resolved[0].isEmpty() || resolved[1].isEmpty()) {
+        return false;
+    }
+    const QString& localSha = resolved[0];
+    const QString& remoteSha = resolved[1];
+    if (localSha == remoteSha) {
+        return true; // already there; trivially an ancestor
+    }
 
     // Local can fast-forward to remote iff local is an ancestor of remote.
     // `merge-base --is-ancestor` exits 0 when true, 1 when false, other on error.
     const GitResult res = runGit(repoPath,
-        {QStringLiteral("merge-base"), QStringLiteral("--is-ancestor"), localRef, remoteRef}, 10000);
+        {QStringLiteral("merge-base"), QStringLiteral("--is-ancestor"), localSha, remoteSha}, 10000);
     return res.exitCode == 0;
 }
 
 bool rebaseBranch(const QString& repoPath, const QString& branch, const QString& remoteName, QString& errorMessage) {
     const QString remoteRef = QStringLiteral("refs/remotes/%1/%2").arg(remoteName, branch);
 
-    if (!runGit(repoPath, {QStringLiteral("rev-parse"), QStringLiteral("--verify"), QStringLiteral("--quiet"), remoteRef}, 10000).ok()) {
+    if (resolveRef(repoPath, remoteRef).isEmpty()) {
         errorMessage = QStringLiteral("Remote branch %1/%2 not found").arg(remoteName, branch);
         return false;
     }
 
     // Make sure the branch we're fast-forwarding is the checked-out one, so the
     // working tree is updated to match (mirrors the previous behavior).
-    const GitResult current = runGit(repoPath, {QStringLiteral("rev-parse"), QStringLiteral("--abbrev-ref"), QStringLiteral("HEAD")}, 10000);
-    if (current.stdOut.trimmed() != branch) {
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(repoPath);
+    const QString current = GitRefDb::isSupported(dirs)
+        ? GitRefDb::currentBranch(dirs)
+        : runGit(repoPath, {QStringLiteral("rev-parse"), QStringLiteral("--abbrev-ref"), QStringLiteral("HEAD")}, 10000).stdOut.trimmed();
+    if (current != branch) {
         const GitResult checkout = runGit(repoPath, {QStringLiteral("checkout"), branch}, 30000);
         if (!checkout.ok()) {
             errorMessage = checkout.stdErr.trimmed().isEmpty()
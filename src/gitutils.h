@@ -6,6 +6,8 @@
 #include <QStringList>
 #include <QProcessEnvironment>
 
+class CommitCountCache;
+
 namespace GitUtils {
 
 /**
@@ -57,6 +59,21 @@ constexpr int GIT_PROCESS_TIMED_OUT = -1002;       // exceeded the supplied time
  */
 GitResult runGit(const QString& workingDir, const QStringList& args, int timeoutMs = 30000);
 
+/**
+ * Resolve revisions (refs, "HEAD", ...) to full object names through the
+ * calling thread's persistent per-repository `git cat-file --batch-check`
+ * co-process (see GitBatchPool), falling back to `git rev-parse` if the
+ * co-process is unavailable. One entry per input; unresolvable revisions map to
+ * an empty string.
+ */
+QStringList resolveRefs(const QString& repoPath, const QStringList& revisions);
+
+/**
+ * Single-revision convenience wrapper around resolveRefs(). Returns an empty
+ * string if the revision doesn't resolve.
+ */
+QString resolveRef(const QString& repoPath, const QString& revision);
+
 /**
  * Check if a path is a valid Git repository or worktree.
  */
@@ -102,6 +119,42 @@ QList<GitRemote> getRepositoryRemotes(const QString& path);
  */
 QString getRepositoryBranch(const QString& path);
 
+/**
+ * Ahead/behind of a local branch relative to one remote's tracking ref.
+ * `valid` is false when the remote has no corresponding branch or the counts
+ * couldn't be computed (ahead/behind are then 0).
+ */
+struct RemoteCommitCounts {
+    QString remoteName;
+    QString remoteRef;  // tracking ref compared against, e.g. "refs/remotes/origin/main"
+    QString localSha;
+    QString remoteSha;
+    int ahead = 0;
+    int behind = 0;
+    bool valid = false;
+};
+
+/**
+ * Calculate commit counts for several remotes of one repository in a single
+ * pass: refs are resolved in one batch and, on git 2.41+, every remote's
+ * ahead/behind comes from one `for-each-ref --format=%(ahead-behind:...)`
+ * invocation. Older git falls back to one `rev-list` per distinct remote tip.
+ * When a cache is given, (local, remote) pairs already in it skip the walk and
+ * newly walked pairs are added to it. Results are returned in the order of
+ * remoteNames.
+ */
+QList<RemoteCommitCounts> calculateAllRemoteCommitCounts(const QString& repoPath, const QString& branch,
+                                                         const QStringList& remoteNames,
+                                                         CommitCountCache* cache = nullptr);
+
+/**
+ * Like calculateAllRemoteCommitCounts(), but never walks history: tips are
+ * resolved (in-process for ordinary repositories) and counts are filled in only
+ * where identical tips or the cache can answer. Cheap enough for the GUI thread.
+ */
+QList<RemoteCommitCounts> cachedRemoteCommitCounts(const QString& repoPath, const QString& branch,
+                                                   const QStringList& remoteNames, CommitCountCache& cache);
+
 /**
  * Calculate commit counts (ahead/behind) for a remote, comparing the local
  * branch against the remote-tracking ref. Writes the results into `remote`.
@@ -1,12 +1,22 @@
+#include "fetchdaemon.h"
 #include "fetchdeeznutzwindow.h"
 
 #include <QApplication>
 #include <QSystemTrayIcon>
 #include <QMessageBox>
 #include <QIcon>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    // Headless mode: checked before any QApplication exists, so no display
+    // connection or widget machinery is ever set up.
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--daemon") == 0) {
+            return runDaemon(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
     
     // Set application properties
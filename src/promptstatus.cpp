@@ -0,0 +1,70 @@
+// fetchdeeznutz-prompt: prints how far the repository containing a directory
+// is ahead of/behind its remotes, for use in a shell prompt. Reads the status
+// snapshot the application maintains; never runs git and needs no Qt.
+//
+//   fetchdeeznutz-prompt [DIR]    DIR defaults to $PWD
+//
+// Prints "+A/-B", "+A" or "-B" (nothing when in sync), followed by "!" if the
+// last fetch failed. Exits 1 when the directory isn't in a tracked repository
+// or the application has not written a snapshot yet.
+
+#include "statussnapshot.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char *argv[])
+{
+    // Must match StatusSnapshot::defaultFilePath(), i.e. Qt's
+    // GenericCacheLocation: ~/Library/Caches on macOS, the XDG cache elsewhere.
+    char snapshotPath[PATH_MAX];
+    const char *home = std::getenv("HOME");
+#ifdef __APPLE__
+    if (!home) {
+        return 1;
+    }
+    std::snprintf(snapshotPath, sizeof(snapshotPath), "%s/Library/Caches/fetchdeeznutz/status.bin", home);
+#else
+    const char *cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome && cacheHome[0] == '/') {
+        std::snprintf(snapshotPath, sizeof(snapshotPath), "%s/fetchdeeznutz/status.bin", cacheHome);
+    } else {
+        if (!home) {
+            return 1;
+        }
+        std::snprintf(snapshotPath, sizeof(snapshotPath), "%s/.cache/fetchdeeznutz/status.bin", home);
+    }
+#endif
+
+    char resolved[PATH_MAX];
+    const char *dir = argc > 1 ? argv[1] : std::getenv("PWD");
+    if (!dir || dir[0] != '/') {
+        dir = ::realpath(dir ? dir : ".", resolved);
+        if (!dir) {
+            return 1;
+        }
+    }
+
+    StatusSnapshot::Reader reader;
+    if (!reader.open(snapshotPath)) {
+        return 1;
+    }
+    const StatusSnapshot::Entry *entry = reader.findContaining(dir, std::strlen(dir));
+    if (!entry) {
+        return 1;
+    }
+
+    if (entry->ahead > 0 && entry->behind > 0) {
+        std::printf("+%d/-%d", entry->ahead, entry->behind);
+    } else if (entry->ahead > 0) {
+        std::printf("+%d", entry->ahead);
+    } else if (entry->behind > 0) {
+        std::printf("-%d", entry->behind);
+    }
+    if (entry->status == StatusSnapshot::Status::Error) {
+        std::printf("!");
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "remotereviewdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QTreeWidget>
+
+RemoteReviewDialog::RemoteReviewDialog(const QList<GitRepository>& repositories, QWidget *parent)
+    : QDialog(parent)
+    , tree(new QTreeWidget())
+    , allRepositories(repositories)
+{
+    setWindowTitle("Select Remotes to Monitor");
+    setModal(true);
+    resize(600, 400);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    // Instructions
+    QLabel *instructionLabel = new QLabel(QString("%1 of the discovered repositories have multiple remotes. "
+                                                  "Please select which ones you want to monitor and fetch from; "
+                                                  "repositories with no remotes selected are skipped:")
+                                              .arg(allRepositories.size()));
+    instructionLabel->setWordWrap(true);
+    mainLayout->addWidget(instructionLabel);
+
+    // One top-level item per repository, one checkable child per remote
+    tree->setColumnCount(2);
+    tree->setHeaderLabels({"Repository / Remote", "URL"});
+    tree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    for (const GitRepository& repo : allRepositories) {
+        QTreeWidgetItem *repoItem = new QTreeWidgetItem(tree);
+        repoItem->setText(0, repo.name);
+        repoItem->setText(1, repo.localPath);
+        repoItem->setFlags(repoItem->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsAutoTristate);
+        for (const GitRemote& remote : repo.remotes) {
+            QTreeWidgetItem *remoteItem = new QTreeWidgetItem(repoItem);
+            remoteItem->setText(0, remote.name);
+            remoteItem->setText(1, remote.url);
+            remoteItem->setFlags(remoteItem->flags() | Qt::ItemIsUserCheckable);
+            remoteItem->setCheckState(0, Qt::Checked); // Default to all selected
+        }
+        repoItem->setExpanded(true);
+    }
+    mainLayout->addWidget(tree);
+
+    // Control buttons
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    QPushButton *selectAllButton = new QPushButton("Select All");
+    QPushButton *selectNoneButton = new QPushButton("Select None");
+
+    connect(selectAllButton, &QPushButton::clicked, this, &RemoteReviewDialog::selectAll);
+    connect(selectNoneButton, &QPushButton::clicked, this, &RemoteReviewDialog::selectNone);
+
+    controlLayout->addWidget(selectAllButton);
+    controlLayout->addWidget(selectNoneButton);
+    controlLayout->addStretch();
+
+    mainLayout->addLayout(controlLayout);
+
+    // Dialog buttons
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    mainLayout->addWidget(buttonBox);
+}
+
+QList<GitRepository> RemoteReviewDialog::getSelectedRepositories() const
+{
+    QList<GitRepository> selected;
+
+    for (int i = 0; i < tree->topLevelItemCount() && i < allRepositories.size(); ++i) {
+        const QTreeWidgetItem *repoItem = tree->topLevelItem(i);
+        GitRepository repo = allRepositories[i];
+        QList<GitRemote> remotes;
+        for (int j = 0; j < repoItem->childCount() && j < repo.remotes.size(); ++j) {
+            if (repoItem->child(j)->checkState(0) == Qt::Checked) {
+                remotes.append(repo.remotes[j]);
+            }
+        }
+        if (!remotes.isEmpty()) {
+            repo.remotes = remotes;
+            selected.append(repo);
+        }
+    }
+
+    return selected;
+}
+
+void RemoteReviewDialog::selectAll()
+{
+    setAllChecked(true);
+}
+
+void RemoteReviewDialog::selectNone()
+{
+    setAllChecked(false);
+}
+
+void RemoteReviewDialog::setAllChecked(bool checked)
+{
+    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
+        tree->topLevelItem(i)->setCheckState(0, checked ? Qt::Checked : Qt::Unchecked);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef REMOTEREVIEWDIALOG_H
+#define REMOTEREVIEWDIALOG_H
+
+#include "gitmodels.h"
+#include <QDialog>
+#include <QList>
+
+class QTreeWidget;
+
+/**
+ * Lets the user pick the remotes to monitor for several repositories at once,
+ * e.g. every multi-remote repository found by a directory scan. Each repository
+ * is listed with its remotes as checkable children, all checked by default.
+ */
+class RemoteReviewDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RemoteReviewDialog(const QList<GitRepository>& repositories, QWidget *parent = nullptr);
+
+    /** Repositories with at least one remote checked, limited to the checked remotes. */
+    QList<GitRepository> getSelectedRepositories() const;
+
+private slots:
+    void selectAll();
+    void selectNone();
+
+private:
+    void setAllChecked(bool checked);
+
+    QTreeWidget *tree;
+    QList<GitRepository> allRepositories;
+};
+
+#endif // REMOTEREVIEWDIALOG_H
@@ -116,7 +116,7 @@ GitRepository RepositoryDialog::getRepository() const
         GitRemote remote;
         remote.name = item->data(RemoteNameRole).toString();
         remote.url = item->data(RemoteUrlRole).toString();
-        remote.status = "Ready";
+        remote.status = FetchStatus::Ready;
         if (!remote.name.isEmpty()) {
             repo.remotes.append(remote);
         }
@@ -0,0 +1,114 @@
+#include "repositoryonboarder.h"
+#include "gitutils.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+
+namespace {
+constexpr int kFlushIntervalMs = 100;
+} // namespace
+
+struct RepositoryOnboarder::Batch {
+    std::atomic<int> cancelGeneration{0}; // probes submitted before this are skipped
+
+    QMutex mutex; // guards the members below
+    QList<GitRepository> ready; // probed since the last flush
+    int finished = 0;           // probes done (or skipped) since the last flush
+};
+
+RepositoryOnboarder::RepositoryOnboarder(QObject *parent)
+    : QObject(parent)
+    , m_pool(new QThreadPool(this))
+    , m_flushTimer(new QTimer(this))
+    , m_batch(std::make_shared<Batch>())
+{
+    // A probe is a few short git processes, so more threads than cores pays off.
+    m_pool->setMaxThreadCount(qMax(4, QThread::idealThreadCount() * 2));
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &RepositoryOnboarder::flush);
+}
+
+RepositoryOnboarder::~RepositoryOnboarder()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+GitRepository RepositoryOnboarder::probeRepository(const QString& path)
+{
+    GitRepository repo;
+    repo.name = GitUtils::getRepositoryName(path);
+    repo.localPath = path;
+    repo.fetchInterval = 60; // Default 1 hour
+    repo.enabled = true;
+    repo.status = FetchStatus::Ready;
+    repo.remotes = GitUtils::getRepositoryRemotes(path);
+    if (repo.remotes.isEmpty()) {
+        return repo; // not usable; skip the rest
+    }
+    repo.branch = GitUtils::getRepositoryBranch(path);
+    repo.worktrees = GitUtils::findWorktreesForRepository(path);
+    return repo;
+}
+
+void RepositoryOnboarder::probe(const QStringList& paths)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
+    m_outstanding += paths.size();
+    m_flushTimer->start();
+
+    const std::shared_ptr<Batch> batch = m_batch;
+    const int generation = batch->cancelGeneration.load();
+    for (const QString& path : paths) {
+        m_pool->start([batch, generation, path]() {
+            const bool skip = batch->cancelGeneration.load() != generation;
+            GitRepository repo;
+            if (!skip) {
+                repo = probeRepository(path);
+            }
+            QMutexLocker lock(&batch->mutex);
+            if (!skip) {
+                batch->ready.append(repo);
+            }
+            ++batch->finished;
+        });
+    }
+}
+
+void RepositoryOnboarder::cancel()
+{
+    ++m_batch->cancelGeneration;
+}
+
+bool RepositoryOnboarder::isBusy() const
+{
+    return m_outstanding > 0;
+}
+
+void RepositoryOnboarder::flush()
+{
+    QList<GitRepository> ready;
+    int finished = 0;
+    {
+        QMutexLocker lock(&m_batch->mutex);
+        ready.swap(m_batch->ready);
+        finished = m_batch->finished;
+        m_batch->finished = 0;
+    }
+    m_outstanding -= finished;
+
+    if (!ready.isEmpty()) {
+        emit repositoriesProbed(ready);
+    }
+    if (m_outstanding <= 0) {
+        m_outstanding = 0;
+        m_flushTimer->stop();
+        emit idle();
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef REPOSITORYONBOARDER_H
+#define REPOSITORYONBOARDER_H
+
+#include "gitmodels.h"
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <memory>
+
+class QThreadPool;
+class QTimer;
+
+/**
+ * Builds GitRepository records (name, branch, remotes, worktrees) for newly
+ * discovered repository paths off the GUI thread. Repositories are probed
+ * concurrently on a thread pool and handed back in batches; nothing is
+ * decided here, so records with several remotes still need the user's choice.
+ *
+ * probe() can be called again while earlier paths are still being probed.
+ */
+class RepositoryOnboarder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RepositoryOnboarder(QObject *parent = nullptr);
+    ~RepositoryOnboarder();
+
+    void probe(const QStringList& paths);
+    /** Drop paths not yet started; probes already running still report. */
+    void cancel();
+    bool isBusy() const;
+
+    /** Probe one repository synchronously. Records without remotes aren't usable. */
+    static GitRepository probeRepository(const QString& path);
+
+signals:
+    void repositoriesProbed(const QList<GitRepository>& repositories);
+    // Everything passed to probe() has been reported.
+    void idle();
+
+private slots:
+    void flush();
+
+private:
+    struct Batch;
+
+    QThreadPool *m_pool;
+    QTimer *m_flushTimer;
+    std::shared_ptr<Batch> m_batch; // results shared with the probe tasks
+    int m_outstanding = 0;          // probes submitted, not yet flushed
+};
+
+#endif // REPOSITORYONBOARDER_H
@@ -0,0 +1,203 @@
+#include "repositoryscanner.h"
+#include "gitutils.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+constexpr int kFlushIntervalMs = 100;
+
+// Identity of a directory for loop detection: device + inode where available,
+// else the canonical path.
+QString directoryIdentity(const QString& path)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) == 0) {
+        return QStringLiteral("%1:%2").arg(quint64(st.st_dev)).arg(quint64(st.st_ino));
+    }
+#endif
+    return QFileInfo(path).canonicalFilePath();
+}
+} // namespace
+
+struct RepositoryScanner::ScanState {
+    QPointer<RepositoryScanner> owner;
+    QThreadPool *pool = nullptr;
+    QSet<QString> excludeDirs; // lower-cased names
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> pendingTasks{0};
+    std::atomic<int> directoryCount{0};
+
+    QMutex mutex; // guards the members below
+    QSet<QString> visitedDirs;  // directoryIdentity() of every directory queued
+    QSet<QString> seenRepos;    // main repository paths already reported
+    QStringList unreported;     // discovered since the last flush
+};
+
+RepositoryScanner::RepositoryScanner(QObject *parent)
+    : QObject(parent)
+    , m_pool(new QThreadPool(this))
+    , m_flushTimer(new QTimer(this))
+{
+    // Listing directories is mostly waiting on the filesystem, so use more
+    // threads than cores.
+    m_pool->setMaxThreadCount(qMax(4, QThread::idealThreadCount() * 2));
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &RepositoryScanner::flush);
+}
+
+RepositoryScanner::~RepositoryScanner()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+void RepositoryScanner::start(const QString& rootPath, const QStringList& excludeDirs)
+{
+    cancel();
+
+    auto state = std::make_shared<ScanState>();
+    state->owner = this;
+    state->pool = m_pool;
+    for (const QString& name : excludeDirs) {
+        state->excludeDirs.insert(name.toLower());
+    }
+    m_state = state;
+    m_flushTimer->start();
+
+    const QString root = QDir(rootPath).absolutePath();
+    state->visitedDirs.insert(directoryIdentity(root));
+    submit(state, root);
+}
+
+void RepositoryScanner::cancel()
+{
+    if (m_state) {
+        m_state->cancelled = true;
+    }
+}
+
+bool RepositoryScanner::isRunning() const
+{
+    return m_state != nullptr;
+}
+
+void RepositoryScanner::submit(const std::shared_ptr<ScanState>& state, const QString& path)
+{
+    ++state->pendingTasks;
+    state->pool->start([state, path]() {
+        if (!state->cancelled) {
+            scanDirectory(state, path);
+        }
+        taskDone(state);
+    });
+}
+
+void RepositoryScanner::taskDone(const std::shared_ptr<ScanState>& state)
+{
+    if (--state->pendingTasks == 0) {
+        // Last task out reports completion on the scanner's thread.
+        QMetaObject::invokeMethod(state->owner, [state]() {
+            if (state->owner) {
+                state->owner->onScanDone(state);
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void RepositoryScanner::scanDirectory(const std::shared_ptr<ScanState>& state, const QString& path)
+{
+    state->directoryCount.fetch_add(1, std::memory_order_relaxed);
+
+    // A repository (or worktree) ends the descent here.
+    if (GitUtils::isGitRepository(path) || GitUtils::isGitWorktree(path)) {
+        const QString mainRepoPath = GitUtils::findMainGitRepository(path);
+        QMutexLocker lock(&state->mutex);
+        if (!state->seenRepos.contains(mainRepoPath)) {
+            state->seenRepos.insert(mainRepoPath);
+            state->unreported.append(mainRepoPath);
+        }
+        return;
+    }
+
+    QStringList subdirs;
+    QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        if (state->cancelled) {
+            return;
+        }
+        const QString subdir = it.next();
+        if (state->excludeDirs.contains(it.fileName().toLower())) {
+            continue;
+        }
+        subdirs.append(subdir);
+    }
+
+    // Identities are computed outside the lock; only the set check is shared.
+    QStringList identities;
+    identities.reserve(subdirs.size());
+    for (const QString& subdir : std::as_const(subdirs)) {
+        identities.append(directoryIdentity(subdir));
+    }
+    QStringList fresh;
+    {
+        QMutexLocker lock(&state->mutex);
+        for (int i = 0; i < subdirs.size(); ++i) {
+            if (identities.at(i).isEmpty() || state->visitedDirs.contains(identities.at(i))) {
+                continue; // unreadable, or already reached via another path
+            }
+            state->visitedDirs.insert(identities.at(i));
+            fresh.append(subdirs.at(i));
+        }
+    }
+    for (const QString& subdir : std::as_const(fresh)) {
+        submit(state, subdir);
+    }
+}
+
+void RepositoryScanner::flush()
+{
+    if (!m_state) {
+        m_flushTimer->stop();
+        return;
+    }
+    QStringList batch;
+    {
+        QMutexLocker lock(&m_state->mutex);
+        batch.swap(m_state->unreported);
+    }
+    if (!batch.isEmpty()) {
+        emit repositoriesFound(batch);
+    }
+}
+
+void RepositoryScanner::onScanDone(const std::shared_ptr<ScanState>& state)
+{
+    if (state != m_state) {
+        return; // superseded by a newer scan
+    }
+    flush();
+    m_flushTimer->stop();
+    m_state.reset();
+
+    int repositoryCount = 0;
+    {
+        QMutexLocker lock(&state->mutex);
+        repositoryCount = state->seenRepos.size();
+    }
+    emit finished(repositoryCount, state->directoryCount.load(), state->cancelled.load());
+}
@@ -0,0 +1,59 @@
+#ifndef REPOSITORYSCANNER_H
+#define REPOSITORYSCANNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <memory>
+
+class QThreadPool;
+class QTimer;
+
+/**
+ * Finds the Git repositories under a directory tree without blocking the GUI
+ * thread. Each directory is listed by its own task on a thread pool, so wide
+ * trees are walked in parallel; discovered repositories are reported in
+ * batches while the walk is still running.
+ *
+ * Like GitUtils::findGitRepositories it doesn't descend into repositories,
+ * skips the excluded directory names, and reports a worktree as its main
+ * repository. Each main repository is reported once (hash-set dedup), and
+ * directories reached twice through symlinks (same device + inode) are only
+ * walked once, which also stops symlink loops.
+ *
+ * One scan runs at a time; start() cancels a scan already in progress.
+ */
+class RepositoryScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RepositoryScanner(QObject *parent = nullptr);
+    ~RepositoryScanner();
+
+    void start(const QString& rootPath, const QStringList& excludeDirs);
+    /** Stop walking; already-queued directories are dropped. finished() still follows. */
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    // Newly discovered main-repository paths, a batch at a time.
+    void repositoriesFound(const QStringList& paths);
+    void finished(int repositoryCount, int directoryCount, bool cancelled);
+
+private slots:
+    void flush();
+
+private:
+    struct ScanState;
+
+    static void scanDirectory(const std::shared_ptr<ScanState>& state, const QString& path);
+    static void submit(const std::shared_ptr<ScanState>& state, const QString& path);
+    static void taskDone(const std::shared_ptr<ScanState>& state);
+    void onScanDone(const std::shared_ptr<ScanState>& state);
+
+    QThreadPool *m_pool;
+    QTimer *m_flushTimer;
+    std::shared_ptr<ScanState> m_state; // current scan, if any
+};
+
+#endif // REPOSITORYSCANNER_H
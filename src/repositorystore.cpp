@@ -10,10 +10,15 @@
 #include <QDateTime>
 
 QString RepositoryStore::configFilePath() const
+{
+    return siblingFilePath("repositories.json");
+}
+
+QString RepositoryStore::siblingFilePath(const QString& fileName) const
 {
     QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
     QDir().mkpath(configDir);
-    return QDir(configDir).filePath("repositories.json");
+    return QDir(configDir).filePath(fileName);
 }
 
 RepositoryStore::LoadResult RepositoryStore::load() const
@@ -23,7 +28,7 @@ RepositoryStore::LoadResult RepositoryStore::load() const
 
     QFile file(configPath);
     if (!file.open(QIODevice::ReadOnly)) {
-        result.messages.append("No existing configuration found, starting fresh");
+        result.messages.append({LogLevel::Info, "No existing configuration found, starting fresh"});
         return result;
     }
 
@@ -31,7 +36,7 @@ RepositoryStore::LoadResult RepositoryStore::load() const
     file.close();
 
     if (data.isEmpty()) {
-        result.messages.append("Configuration file is empty, starting fresh");
+        result.messages.append({LogLevel::Warning, "Configuration file is empty, starting fresh"});
         return result;
     }
 
@@ -39,21 +44,21 @@ RepositoryStore::LoadResult RepositoryStore::load() const
     const QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
 
     if (parseError.error != QJsonParseError::NoError) {
-        result.messages.append(QString("Failed to parse configuration file: %1 at offset %2")
-                                   .arg(parseError.errorString())
-                                   .arg(parseError.offset));
-        result.messages.append("Configuration file may be corrupted. Starting fresh.");
+        result.messages.append({LogLevel::Error, QString("Failed to parse configuration file: %1 at offset %2")
+                                                     .arg(parseError.errorString())
+                                                     .arg(parseError.offset)});
+        result.messages.append({LogLevel::Error, "Configuration file may be corrupted. Starting fresh."});
 
         const QString backupPath = configPath + ".corrupted." +
                                    QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
         if (QFile::copy(configPath, backupPath)) {
-            result.messages.append(QString("Corrupted file backed up to: %1").arg(backupPath));
+            result.messages.append({LogLevel::Warning, QString("Corrupted file backed up to: %1").arg(backupPath)});
         }
         return result;
     }
 
     if (!doc.isArray()) {
-        result.messages.append("Configuration file format is invalid (expected array), starting fresh");
+        result.messages.append({LogLevel::Error, "Configuration file format is invalid (expected array), starting fresh"});
         return result;
     }
 
@@ -64,12 +69,23 @@ RepositoryStore::LoadResult RepositoryStore::load() const
         }
     }
 
-    result.messages.append(QString("Loaded %1 repositories from configuration")
-                               .arg(result.repositories.size()));
+    result.messages.append({LogLevel::Info, QString("Loaded %1 repositories from configuration")
+                                                .arg(result.repositories.size())});
     return result;
 }
 
 bool RepositoryStore::save(const QList<GitRepository>& repositories, QString* errorMessage) const
+{
+    QJsonArray array;
+    for (const GitRepository& repo : repositories) {
+        array.append(repo.toJson());
+    }
+
+    const QJsonDocument doc(array);
+    return writeFileAtomically(configFilePath(), doc.toJson(), errorMessage);
+}
+
+bool RepositoryStore::writeFileAtomically(const QString& path, const QByteArray& data, QString* errorMessage)
 {
     const auto fail = [errorMessage](const QString& reason) {
         if (errorMessage) {
@@ -78,24 +94,16 @@ bool RepositoryStore::save(const QList<GitRepository>& repositories, QString* er
         return false;
     };
 
-    QJsonArray array;
-    for (const GitRepository& repo : repositories) {
-        array.append(repo.toJson());
-    }
-
-    const QJsonDocument doc(array);
-    const QString configPath = configFilePath();
-    const QString tempPath = configPath + ".tmp";
+    const QString tempPath = path + ".tmp";
 
     // Write to a temporary file first so a crash mid-write can't corrupt the
-    // existing config.
+    // existing file.
     QFile tempFile(tempPath);
     if (!tempFile.open(QIODevice::WriteOnly)) {
         return fail("cannot create temporary file");
     }
 
-    const QByteArray jsonData = doc.toJson();
-    if (tempFile.write(jsonData) != jsonData.size()) {
+    if (tempFile.write(data) != data.size()) {
         tempFile.remove();
         return fail("write error");
     }
@@ -107,12 +115,12 @@ bool RepositoryStore::save(const QList<GitRepository>& repositories, QString* er
     tempFile.close();
 
     // Atomically replace the original file with the temporary file.
-    QFile oldFile(configPath);
+    QFile oldFile(path);
     if (oldFile.exists()) {
         oldFile.remove();
     }
 
-    if (!QFile::rename(tempPath, configPath)) {
+    if (!QFile::rename(tempPath, path)) {
         QFile::remove(tempPath);
         return fail("cannot replace file");
     }
@@ -2,7 +2,9 @@
 #define REPOSITORYSTORE_H
 
 #include "gitmodels.h"
+#include <QByteArray>
 #include <QList>
+#include <QPair>
 #include <QString>
 #include <QStringList>
 
@@ -18,12 +20,18 @@ class RepositoryStore
 public:
     struct LoadResult {
         QList<GitRepository> repositories;
-        QStringList messages; // human-readable status lines for the caller to log
+        QList<QPair<LogLevel, QString>> messages; // status lines for the caller to log
     };
 
     /** Absolute path to the JSON config file (creating the config dir). */
     QString configFilePath() const;
 
+    /**
+     * Absolute path of another state file kept alongside the config file
+     * (creating the config dir).
+     */
+    QString siblingFilePath(const QString& fileName) const;
+
     /**
      * Load repositories from disk. On a parse error the corrupt file is backed
      * up and an empty list is returned, with an explanation in messages.
@@ -35,6 +43,12 @@ public:
      * on success; on failure sets *errorMessage when provided.
      */
     bool save(const QList<GitRepository>& repositories, QString* errorMessage = nullptr) const;
+
+    /**
+     * Write data to path atomically (temp file + rename), so a crash mid-write
+     * can't leave a truncated file behind. Shared by the other state files.
+     */
+    static bool writeFileAtomically(const QString& path, const QByteArray& data, QString* errorMessage = nullptr);
 };
 
 #endif // REPOSITORYSTORE_H
@@ -1,14 +1,30 @@
 #include "repositorytreemodel.h"
+#include "fetchcore.h"
 
 #include <QDateTime>
 #include <QFileInfo>
 #include <QMap>
+#include <QTimer>
+#include <algorithm>
+#include <utility>
 
-RepositoryTreeModel::RepositoryTreeModel(const QList<GitRepository>* repositories, QObject* parent)
+namespace {
+constexpr int kFlushIntervalMs = 16; // about one frame
+
+QString directoryOf(const GitRepository& repo)
+{
+    return QFileInfo(repo.localPath).absolutePath();
+}
+} // namespace
+
+RepositoryTreeModel::RepositoryTreeModel(FetchCore* core, QObject* parent)
     : QAbstractItemModel(parent)
-    , m_repositories(repositories)
-    , m_root(std::make_unique<Node>())
+    , m_core(core)
+    , m_flushTimer(new QTimer(this))
 {
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &RepositoryTreeModel::flushDirty);
     buildTree();
 }
 
@@ -16,51 +32,230 @@ RepositoryTreeModel::~RepositoryTreeModel() = default;
 
 void RepositoryTreeModel::buildTree()
 {
-    m_root = std::make_unique<Node>();
+    // The reset repaints everything, and the dirty nodes are about to go.
+    m_dirty.clear();
+    m_flushTimer->stop();
+    m_dirNodes.clear();
+    m_repoNodes.clear();
+    m_activeRemotes.clear();
+    m_freeNodes.clear();
+    m_arena.clear();
+    m_root = allocNode();
     m_root->type = NodeType::Directory;
 
-    if (!m_repositories) {
+    if (!m_core) {
         return;
     }
 
-    // Group repository indices by their parent directory, keeping directories
+    // Group repositories by their parent directory, keeping directories
     // ordered (QMap is sorted by key) to match the previous tree ordering.
-    QMap<QString, QList<int>> pathToRepos;
-    for (int i = 0; i < m_repositories->size(); ++i) {
-        const QString dirPath = QFileInfo(m_repositories->at(i).localPath).absolutePath();
-        pathToRepos[dirPath].append(i);
+    QMap<QString, QList<const GitRepository*>> pathToRepos;
+    for (const GitRepository& repo : m_core->repositories()) {
+        pathToRepos[directoryOf(repo)].append(&repo);
     }
 
+    m_repoNodes.reserve(m_core->repositories().size());
+    m_root->children.reserve(pathToRepos.size());
     for (auto it = pathToRepos.constBegin(); it != pathToRepos.constEnd(); ++it) {
-        auto dirNode = std::make_unique<Node>();
+        Node* dirNode = allocNode();
         dirNode->type = NodeType::Directory;
         dirNode->dirPath = it.key();
-        dirNode->parent = m_root.get();
+        dirNode->parent = m_root;
         dirNode->row = static_cast<int>(m_root->children.size());
+        m_root->children.push_back(dirNode);
+        m_dirNodes.insert(dirNode->dirPath, dirNode);
 
-        for (int repoIndex : it.value()) {
-            auto repoNode = std::make_unique<Node>();
-            repoNode->type = NodeType::Repository;
-            repoNode->repoIndex = repoIndex;
-            repoNode->parent = dirNode.get();
-            repoNode->row = static_cast<int>(dirNode->children.size());
-
-            const GitRepository& repo = m_repositories->at(repoIndex);
-            for (int r = 0; r < repo.remotes.size(); ++r) {
-                auto remoteNode = std::make_unique<Node>();
-                remoteNode->type = NodeType::Remote;
-                remoteNode->repoIndex = repoIndex;
-                remoteNode->remoteIndex = r;
-                remoteNode->parent = repoNode.get();
-                remoteNode->row = static_cast<int>(repoNode->children.size());
-                repoNode->children.push_back(std::move(remoteNode));
-            }
+        dirNode->children.reserve(it.value().size());
+        for (const GitRepository* repo : it.value()) {
+            appendRepositoryNode(dirNode, *repo);
+        }
+    }
+}
+
+RepositoryTreeModel::Node* RepositoryTreeModel::allocNode()
+{
+    if (!m_freeNodes.empty()) {
+        Node* node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        *node = Node();
+        return node;
+    }
+    return &m_arena.emplace_back();
+}
+
+RepositoryTreeModel::Node* RepositoryTreeModel::appendRepositoryNode(Node* dirNode, const GitRepository& repo)
+{
+    // Its remote rows are added by fetchMore(), once the row is expanded.
+    Node* repoNode = allocNode();
+    repoNode->type = NodeType::Repository;
+    repoNode->repoId = repo.id;
+    repoNode->parent = dirNode;
+    repoNode->row = static_cast<int>(dirNode->children.size());
+    dirNode->children.push_back(repoNode);
+    m_repoNodes.insert(repo.id, repoNode);
+    return repoNode;
+}
+
+void RepositoryTreeModel::appendRemoteNode(Node* repoNode, int remoteIndex)
+{
+    Node* remoteNode = allocNode();
+    remoteNode->type = NodeType::Remote;
+    remoteNode->repoId = repoNode->repoId;
+    remoteNode->remoteIndex = remoteIndex;
+    remoteNode->parent = repoNode;
+    remoteNode->row = static_cast<int>(repoNode->children.size());
+    repoNode->children.push_back(remoteNode);
+    trackActive(remoteNode);
+}
+
+RepositoryTreeModel::Node* RepositoryTreeModel::directoryNode(const QString& dirPath)
+{
+    if (Node* dirNode = m_dirNodes.value(dirPath)) {
+        return dirNode;
+    }
+
+    auto& dirs = m_root->children;
+    const auto pos = std::lower_bound(dirs.begin(), dirs.end(), dirPath, [](const Node* dir, const QString& path) {
+        return dir->dirPath < path;
+    });
+    const int row = static_cast<int>(pos - dirs.begin());
+    Node* dirNode = allocNode();
+    dirNode->type = NodeType::Directory;
+    dirNode->dirPath = dirPath;
+    dirNode->parent = m_root;
+
+    beginInsertRows(QModelIndex(), row, row);
+    dirs.insert(pos, dirNode);
+    renumber(m_root, row);
+    m_dirNodes.insert(dirPath, dirNode);
+    endInsertRows();
+    return dirNode;
+}
+
+void RepositoryTreeModel::renumber(Node* parent, int from)
+{
+    for (int row = from; row < static_cast<int>(parent->children.size()); ++row) {
+        parent->children[row]->row = row;
+    }
+}
+
+void RepositoryTreeModel::removeChildRows(Node* parent, int first, int last)
+{
+    beginRemoveRows(indexForNode(parent), first, last);
+    for (int row = first; row <= last; ++row) {
+        forget(parent->children[row]);
+    }
+    parent->children.erase(parent->children.begin() + first, parent->children.begin() + last + 1);
+    renumber(parent, first);
+    endRemoveRows();
+}
+
+void RepositoryTreeModel::forget(Node* node)
+{
+    for (Node* child : node->children) {
+        forget(child);
+    }
+    if (node->dirty) {
+        m_dirty.erase(std::remove(m_dirty.begin(), m_dirty.end(), node), m_dirty.end());
+    }
+    m_activeRemotes.remove(node);
+    if (node->type == NodeType::Repository) {
+        m_repoNodes.remove(node->repoId);
+    } else if (node->type == NodeType::Directory) {
+        m_dirNodes.remove(node->dirPath);
+    }
+    m_freeNodes.push_back(node);
+}
+
+void RepositoryTreeModel::loadRemotes(Node* repoNode)
+{
+    repoNode->remotesLoaded = true;
+    const GitRepository* repo = repository(repoNode);
+    if (!repo || repo->remotes.isEmpty()) {
+        return;
+    }
+    beginInsertRows(indexForNode(repoNode), 0, static_cast<int>(repo->remotes.size()) - 1);
+    repoNode->children.reserve(repo->remotes.size());
+    for (int r = 0; r < repo->remotes.size(); ++r) {
+        appendRemoteNode(repoNode, r);
+    }
+    endInsertRows();
+}
+
+QModelIndex RepositoryTreeModel::insertRepository(RepositoryId repoId)
+{
+    const GitRepository* repo = m_core->repository(repoId);
+    if (!repo || m_repoNodes.contains(repoId)) {
+        return indexForRepository(repoId);
+    }
+    Node* dirNode = directoryNode(directoryOf(*repo));
+    const int row = static_cast<int>(dirNode->children.size());
+    beginInsertRows(indexForNode(dirNode), row, row);
+    Node* repoNode = appendRepositoryNode(dirNode, *repo);
+    endInsertRows();
+    return indexForNode(repoNode);
+}
 
-            dirNode->children.push_back(std::move(repoNode));
+void RepositoryTreeModel::removeRepository(RepositoryId repoId)
+{
+    Node* repoNode = m_repoNodes.value(repoId);
+    if (!repoNode) {
+        return;
+    }
+    Node* dirNode = repoNode->parent;
+    if (dirNode->children.size() == 1) {
+        removeChildRows(m_root, dirNode->row, dirNode->row);
+    } else {
+        removeChildRows(dirNode, repoNode->row, repoNode->row);
+    }
+}
+
+QModelIndex RepositoryTreeModel::updateRepository(RepositoryId repoId)
+{
+    const GitRepository* repo = m_core->repository(repoId);
+    Node* repoNode = m_repoNodes.value(repoId);
+    if (!repo || !repoNode || repoNode->parent->dirPath != directoryOf(*repo)) {
+        removeRepository(repoId);
+        return insertRepository(repoId);
+    }
+
+    markDirty(repoNode);
+    if (!repoNode->remotesLoaded) {
+        return indexForNode(repoNode); // nothing to catch up until expanded
+    }
+
+    // Remote rows are positional; keep as many as the repository now has.
+    const int rows = static_cast<int>(repoNode->children.size());
+    const int remotes = static_cast<int>(repo->remotes.size());
+    if (remotes < rows) {
+        removeChildRows(repoNode, remotes, rows - 1);
+    } else if (remotes > rows) {
+        beginInsertRows(indexForNode(repoNode), rows, remotes - 1);
+        for (int r = rows; r < remotes; ++r) {
+            appendRemoteNode(repoNode, r);
         }
+        endInsertRows();
+    }
 
-        m_root->children.push_back(std::move(dirNode));
+    for (Node* remoteNode : repoNode->children) {
+        trackActive(remoteNode);
+        markDirty(remoteNode);
     }
+    return indexForNode(repoNode);
+}
+
+const GitRepository* RepositoryTreeModel::repository(const Node* node) const
+{
+    return m_core ? m_core->repository(node->repoId) : nullptr;
+}
+
+const GitRemote* RepositoryTreeModel::remote(const Node* node) const
+{
+    const GitRepository* repo = repository(node);
+    if (!repo || node->remoteIndex < 0 || node->remoteIndex >= repo->remotes.size()) {
+        return nullptr;
+    }
+    return &repo->remotes.at(node->remoteIndex);
 }
 
 void RepositoryTreeModel::rebuild()
@@ -73,14 +268,14 @@ void RepositoryTreeModel::rebuild()
 RepositoryTreeModel::Node* RepositoryTreeModel::nodeFromIndex(const QModelIndex& index) const
 {
     if (!index.isValid()) {
-        return m_root.get();
+        return m_root;
     }
     return static_cast<Node*>(index.internalPointer());
 }
 
 QModelIndex RepositoryTreeModel::indexForNode(Node* node) const
 {
-    if (!node || node == m_root.get()) {
+    if (!node || node == m_root) {
         return QModelIndex();
     }
     return createIndex(node->row, 0, node);
@@ -95,7 +290,7 @@ QModelIndex RepositoryTreeModel::index(int row, int column, const QModelIndex& p
     if (row < 0 || row >= static_cast<int>(parentNode->children.size())) {
         return QModelIndex();
     }
-    return createIndex(row, column, parentNode->children[row].get());
+    return createIndex(row, column, parentNode->children[row]);
 }
 
 QModelIndex RepositoryTreeModel::parent(const QModelIndex& child) const
@@ -116,6 +311,35 @@ int RepositoryTreeModel::rowCount(const QModelIndex& parent) const
     return static_cast<int>(node->children.size());
 }
 
+bool RepositoryTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) {
+        return false;
+    }
+    const Node* node = nodeFromIndex(parent);
+    if (node->type == NodeType::Repository && !node->remotesLoaded) {
+        const GitRepository* repo = repository(node);
+        return repo && !repo->remotes.isEmpty();
+    }
+    return !node->children.empty();
+}
+
+bool RepositoryTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) {
+        return false;
+    }
+    const Node* node = nodeFromIndex(parent);
+    return node->type == NodeType::Repository && !node->remotesLoaded;
+}
+
+void RepositoryTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (canFetchMore(parent)) {
+        loadRemotes(nodeFromIndex(parent));
+    }
+}
+
 int RepositoryTreeModel::columnCount(const QModelIndex& /*parent*/) const
 {
     return 1;
@@ -126,13 +350,27 @@ QVariant RepositoryTreeModel::data(const QModelIndex& index, int role) const
     if (!index.isValid()) {
         return QVariant();
     }
-    const Node* node = nodeFromIndex(index);
+    Node* node = nodeFromIndex(index);
 
+    // Formatted once and kept until the node's data changes, so painting and
+    // scrolling are lookups. In-flight remotes carry a live elapsed counter
+    // and are formatted afresh; there are only as many as fetches running.
     switch (role) {
     case Qt::DisplayRole:
-        return displayText(node);
+        if (m_activeRemotes.contains(node)) {
+            return displayText(node);
+        }
+        if (!node->displayCached) {
+            node->display = displayText(node);
+            node->displayCached = true;
+        }
+        return node->display;
     case Qt::ToolTipRole:
-        return toolTip(node);
+        if (!node->toolTipCached) {
+            node->toolTip = toolTip(node);
+            node->toolTipCached = true;
+        }
+        return node->toolTip;
     default:
         return QVariant();
     }
@@ -148,7 +386,7 @@ QVariant RepositoryTreeModel::headerData(int section, Qt::Orientation orientatio
 
 QString RepositoryTreeModel::displayText(const Node* node) const
 {
-    if (!node || !m_repositories) {
+    if (!node) {
         return QString();
     }
 
@@ -157,43 +395,66 @@ QString RepositoryTreeModel::displayText(const Node* node) const
     }
 
     if (node->type == NodeType::Repository) {
-        const GitRepository& repo = m_repositories->at(node->repoIndex);
-        QString statusIcon = repo.enabled ? QStringLiteral("\u25CF") : QStringLiteral("\u25CB");
-        const QString statusText = repo.status.isEmpty() ? QStringLiteral("Ready") : repo.status;
-
-        if (statusText == "Timeout") {
+        const GitRepository* found = repository(node);
+        if (!found) {
+            return QString(); // no longer tracked; the row is about to go
+        }
+        const GitRepository& repo = *found;
+        QString statusIcon;
+        switch (repo.status) {
+        case FetchStatus::Timeout:
             statusIcon = QStringLiteral("\u23F0");
-        } else if (statusText == "Error") {
+            break;
+        case FetchStatus::Error:
             statusIcon = QStringLiteral("\u274C");
-        } else if (statusText == "Success") {
+            break;
+        case FetchStatus::Success:
             statusIcon = QStringLiteral("\u2705");
-        } else if (statusText == "Fetching...") {
+            break;
+        case FetchStatus::Fetching:
             statusIcon = QStringLiteral("\U0001F504");
+            break;
+        default:
+            statusIcon = repo.enabled ? QStringLiteral("\u25CF") : QStringLiteral("\u25CB");
+            break;
         }
 
         return QStringLiteral("%1 %2 - %3 (%4) [%5 remotes]")
-            .arg(statusIcon, repo.name, statusText, repo.branch)
+            .arg(statusIcon, repo.name, fetchStatusText(repo.status), repo.branch)
             .arg(repo.remotes.size());
     }
 
     // Remote node
-    const GitRepository& repo = m_repositories->at(node->repoIndex);
-    const GitRemote& remote = repo.remotes.at(node->remoteIndex);
+    const GitRemote* found = remote(node);
+    if (!found) {
+        return QString();
+    }
+    const GitRemote& remote = *found;
 
-    QString remoteStatusIcon = QStringLiteral("\u25CF");
-    const QString remoteStatus = remote.status.isEmpty() ? QStringLiteral("Ready") : remote.status;
-    if (remoteStatus == "Error") {
+    QString remoteStatusIcon;
+    switch (remote.status) {
+    case FetchStatus::Error:
         remoteStatusIcon = QStringLiteral("\u274C");
-    } else if (remoteStatus == "Success") {
+        break;
+    case FetchStatus::Success:
+    case FetchStatus::UpToDate:
         remoteStatusIcon = QStringLiteral("\u2705");
-    } else if (remoteStatus == "Fetching...") {
+        break;
+    case FetchStatus::Fetching:
         remoteStatusIcon = QStringLiteral("\U0001F504");
-    } else if (remoteStatus == "Timeout") {
+        break;
+    case FetchStatus::Timeout:
         remoteStatusIcon = QStringLiteral("\u23F0");
-    } else if (remoteStatus == "Queued") {
+        break;
+    case FetchStatus::Queued:
         remoteStatusIcon = QStringLiteral("\u23F3");
-    } else if (remoteStatus == "Cancelled") {
+        break;
+    case FetchStatus::Cancelled:
         remoteStatusIcon = QStringLiteral("\u26A0");
+        break;
+    default:
+        remoteStatusIcon = QStringLiteral("\u25CF");
+        break;
     }
 
     QString delta;
@@ -211,13 +472,16 @@ QString RepositoryTreeModel::displayText(const Node* node) const
     // a glance (it sits on "Fetching..." while siblings move to Success/Error).
     // For in-flight remotes append a live elapsed counter so a stall reads as a
     // climbing number rather than a static label.
-    QString statusLabel = remoteStatus;
-    if (remoteStatus == "Fetching..." && remote.fetchStartMs > 0) {
+    QString statusLabel = fetchStatusText(remote.status);
+    if (remote.status == FetchStatus::Fetching && remote.fetchStartMs > 0) {
         const qint64 elapsedS = (QDateTime::currentMSecsSinceEpoch() - remote.fetchStartMs) / 1000;
         statusLabel = QStringLiteral("Fetching... %1s").arg(elapsedS);
+        if (!remote.progressText.isEmpty()) {
+            statusLabel += QStringLiteral(" (%1)").arg(remote.progressText);
+        }
     }
     QString statusSuffix;
-    if (remoteStatus != "Ready" && remoteStatus != "Success") {
+    if (remote.status != FetchStatus::Ready && remote.status != FetchStatus::Success) {
         statusSuffix = QStringLiteral(" - %1").arg(statusLabel);
     }
 
@@ -226,16 +490,18 @@ QString RepositoryTreeModel::displayText(const Node* node) const
 
 QString RepositoryTreeModel::toolTip(const Node* node) const
 {
-    if (!node || !m_repositories) {
+    if (!node) {
         return QString();
     }
 
     if (node->type == NodeType::Remote) {
-        const GitRepository& repo = m_repositories->at(node->repoIndex);
-        const GitRemote& remote = repo.remotes.at(node->remoteIndex);
+        const GitRemote* found = remote(node);
+        if (!found) {
+            return QString();
+        }
+        const GitRemote& remote = *found;
         QString tip = QStringLiteral("Remote: %1\nURL: %2\nStatus: %3\nAhead: %4 commits\nBehind: %5 commits")
-                          .arg(remote.name, remote.url,
-                               remote.status.isEmpty() ? QStringLiteral("Ready") : remote.status)
+                          .arg(remote.name, remote.url, fetchStatusText(remote.status))
                           .arg(remote.commitsAhead)
                           .arg(remote.commitsBehind);
         if (!remote.lastFetch.isEmpty()) {
@@ -244,15 +510,15 @@ QString RepositoryTreeModel::toolTip(const Node* node) const
         return tip;
     }
 
-    if (node->type != NodeType::Repository) {
+    const GitRepository* found = node->type == NodeType::Repository ? repository(node) : nullptr;
+    if (!found) {
         return QString();
     }
-
-    const GitRepository& repo = m_repositories->at(node->repoIndex);
+    const GitRepository& repo = *found;
     QString tooltip = QStringLiteral("<b>%1</b><br/>").arg(repo.name);
     tooltip += QStringLiteral("Path: %1<br/>").arg(repo.localPath);
     tooltip += QStringLiteral("Branch: %1<br/>").arg(repo.branch);
-    tooltip += QStringLiteral("Status: %1<br/>").arg(repo.status.isEmpty() ? QStringLiteral("Ready") : repo.status);
+    tooltip += QStringLiteral("Status: %1<br/>").arg(fetchStatusText(repo.status));
     if (!repo.lastFetch.isEmpty()) {
         tooltip += QStringLiteral("Last Fetch: %1<br/>").arg(repo.lastFetch);
     }
@@ -266,7 +532,7 @@ QString RepositoryTreeModel::toolTip(const Node* node) const
         for (const GitRemote& remote : repo.remotes) {
             tooltip += QStringLiteral("\u2022 <b>%1</b><br/>").arg(remote.name);
             tooltip += QStringLiteral("  URL: %1<br/>").arg(remote.url);
-            tooltip += QStringLiteral("  Status: %1<br/>").arg(remote.status.isEmpty() ? QStringLiteral("Ready") : remote.status);
+            tooltip += QStringLiteral("  Status: %1<br/>").arg(fetchStatusText(remote.status));
             if (remote.commitsAhead > 0 || remote.commitsBehind > 0) {
                 tooltip += QStringLiteral("  Commits: ");
                 if (remote.commitsAhead > 0) {
@@ -288,61 +554,87 @@ QString RepositoryTreeModel::toolTip(const Node* node) const
     return tooltip;
 }
 
-void RepositoryTreeModel::updateRepositoryStatus(const QString& repoName)
+void RepositoryTreeModel::markDirty(Node* node)
 {
-    if (!m_repositories) {
+    node->displayCached = false;
+    node->toolTipCached = false;
+    if (node->type == NodeType::Remote) {
+        node->parent->toolTipCached = false; // the repository's tooltip lists its remotes
+    }
+    if (node->dirty) {
         return;
     }
-    for (const auto& dir : m_root->children) {
-        for (const auto& repoNode : dir->children) {
-            if (m_repositories->at(repoNode->repoIndex).name == repoName) {
-                const QModelIndex idx = indexForNode(repoNode.get());
-                emit dataChanged(idx, idx);
-            }
+    node->dirty = true;
+    m_dirty.push_back(node);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void RepositoryTreeModel::trackActive(Node* remoteNode)
+{
+    const GitRemote* remote = this->remote(remoteNode);
+    if (remote && remote->status == FetchStatus::Fetching) {
+        m_activeRemotes.insert(remoteNode);
+    } else {
+        m_activeRemotes.remove(remoteNode);
+    }
+}
+
+void RepositoryTreeModel::flushDirty()
+{
+    // Group by parent, then by row, so adjacent rows go out as one range.
+    std::vector<Node*> dirty = std::exchange(m_dirty, {});
+    std::sort(dirty.begin(), dirty.end(), [](const Node* a, const Node* b) {
+        return a->parent != b->parent ? a->parent < b->parent : a->row < b->row;
+    });
+    for (size_t i = 0; i < dirty.size();) {
+        size_t last = i;
+        while (last + 1 < dirty.size() && dirty[last + 1]->parent == dirty[i]->parent
+               && dirty[last + 1]->row == dirty[last]->row + 1) {
+            ++last;
+        }
+        for (size_t k = i; k <= last; ++k) {
+            dirty[k]->dirty = false;
         }
+        emit dataChanged(indexForNode(dirty[i]), indexForNode(dirty[last]));
+        i = last + 1;
     }
 }
 
-void RepositoryTreeModel::updateRemoteCounts(const QString& repoName, const QString& remoteName)
+void RepositoryTreeModel::updateRepositoryStatus(RepositoryId repoId)
 {
-    if (!m_repositories) {
+    if (Node* repoNode = m_repoNodes.value(repoId)) {
+        markDirty(repoNode);
+    }
+}
+
+void RepositoryTreeModel::updateRemoteCounts(RepositoryId repoId, const QString& remoteName)
+{
+    Node* repoNode = m_repoNodes.value(repoId);
+    if (!repoNode) {
         return;
     }
-    for (const auto& dir : m_root->children) {
-        for (const auto& repoNode : dir->children) {
-            const GitRepository& repo = m_repositories->at(repoNode->repoIndex);
-            if (repo.name != repoName) {
-                continue;
-            }
-            for (const auto& remoteNode : repoNode->children) {
-                if (repo.remotes.at(remoteNode->remoteIndex).name == remoteName) {
-                    const QModelIndex idx = indexForNode(remoteNode.get());
-                    emit dataChanged(idx, idx);
-                }
-            }
+    // Unexpanded repositories have no remote rows; only the tooltip lists them.
+    repoNode->toolTipCached = false;
+    for (Node* remoteNode : repoNode->children) {
+        const GitRemote* remote = this->remote(remoteNode);
+        if (remote && remote->name == remoteName) {
+            trackActive(remoteNode);
+            markDirty(remoteNode);
+            return;
         }
     }
 }
 
-int RepositoryTreeModel::refreshActiveRemotes()
+int RepositoryTreeModel::refreshActiveRemotes(const std::function<bool(const QModelIndex&)>& isVisible)
 {
-    if (!m_repositories) {
-        return 0;
-    }
-    int active = 0;
-    for (const auto& dir : m_root->children) {
-        for (const auto& repoNode : dir->children) {
-            const GitRepository& repo = m_repositories->at(repoNode->repoIndex);
-            for (const auto& remoteNode : repoNode->children) {
-                if (repo.remotes.at(remoteNode->remoteIndex).status == QStringLiteral("Fetching...")) {
-                    ++active;
-                    const QModelIndex idx = indexForNode(remoteNode.get());
-                    emit dataChanged(idx, idx);
-                }
-            }
+    for (Node* remoteNode : std::as_const(m_activeRemotes)) {
+        if (isVisible(indexForNode(remoteNode))) {
+            markDirty(remoteNode);
         }
     }
-    return active;
+    return static_cast<int>(m_activeRemotes.size());
 }
 
 bool RepositoryTreeModel::isRepository(const QModelIndex& index) const
@@ -361,12 +653,12 @@ bool RepositoryTreeModel::isDirectory(const QModelIndex& index) const
     return nodeFromIndex(index)->type == NodeType::Directory;
 }
 
-int RepositoryTreeModel::repositoryIndex(const QModelIndex& index) const
+RepositoryId RepositoryTreeModel::repositoryId(const QModelIndex& index) const
 {
     if (!index.isValid()) {
-        return -1;
+        return 0;
     }
-    return nodeFromIndex(index)->repoIndex;
+    return nodeFromIndex(index)->repoId;
 }
 
 QString RepositoryTreeModel::directoryPath(const QModelIndex& index) const
@@ -378,18 +670,7 @@ QString RepositoryTreeModel::directoryPath(const QModelIndex& index) const
     return node->type == NodeType::Directory ? node->dirPath : QString();
 }
 
-QModelIndex RepositoryTreeModel::indexForRepository(const QString& name, const QString& localPath) const
+QModelIndex RepositoryTreeModel::indexForRepository(RepositoryId repoId) const
 {
-    if (!m_repositories) {
-        return QModelIndex();
-    }
-    for (const auto& dir : m_root->children) {
-        for (const auto& repoNode : dir->children) {
-            const GitRepository& repo = m_repositories->at(repoNode->repoIndex);
-            if (repo.name == name && repo.localPath == localPath) {
-                return indexForNode(repoNode.get());
-            }
-        }
-    }
-    return QModelIndex();
+    return indexForNode(m_repoNodes.value(repoId));
 }
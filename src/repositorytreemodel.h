@@ -3,11 +3,17 @@
 
 #include "gitmodels.h"
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
+#include <QSet>
 #include <QString>
-#include <memory>
+#include <deque>
+#include <functional>
 #include <vector>
 
+class FetchCore;
+class QTimer;
+
 /**
  * Tree model presenting the repository list as a three-level hierarchy:
  *
@@ -15,11 +21,23 @@
  *     Repository
  *       Remote
  *
- * The model reads from a repository list owned by the caller (the window). For
- * structural changes (add/remove/scan/load) the caller invokes rebuild(); for
- * value-only changes (status, commit counts) it invokes the incremental
- * update methods, which emit dataChanged without resetting the model so the
- * view keeps its selection, expansion and scroll position.
+ * The model reads the core's repositories, by id. After loading the caller
+ * invokes rebuild(); when repositories are added, edited or removed it invokes
+ * insertRepository(), updateRepository() or removeRepository(), which insert
+ * and remove just the affected rows (and a directory row when its first
+ * repository arrives or its last one leaves). For value-only changes (status,
+ * commit counts) it invokes the update methods, which emit dataChanged. None
+ * of these reset the model, so the view keeps its selection, expansion and
+ * scroll position, and each costs time in proportion to the change: rows are
+ * found by id in a hash. Value updates only mark a row dirty: dirty rows are repainted
+ * together once per frame (~16 ms), one dataChanged per run of adjacent rows,
+ * so a fetch wave's thousands of updates don't each cost a repaint. Each
+ * node's display text and tooltip are formatted once and cached until then.
+ *
+ * Remote rows are created lazily, through fetchMore(), when their repository
+ * is first expanded, so a large configuration costs one node per directory
+ * and repository until the user looks inside. Nodes live in an arena owned by
+ * the model and are recycled when their rows are removed.
  */
 class RepositoryTreeModel : public QAbstractItemModel
 {
@@ -28,7 +46,7 @@ class RepositoryTreeModel : public QAbstractItemModel
 public:
     enum class NodeType { Directory, Repository, Remote };
 
-    explicit RepositoryTreeModel(const QList<GitRepository>* repositories, QObject* parent = nullptr);
+    explicit RepositoryTreeModel(FetchCore* core, QObject* parent = nullptr);
     ~RepositoryTreeModel() override;
 
     // QAbstractItemModel interface
@@ -36,51 +54,105 @@ public:
     QModelIndex parent(const QModelIndex& child) const override;
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
-    /** Rebuild the whole tree from the repository list (full model reset). */
+    /** Rebuild the whole tree from the core's repositories (full model reset). */
     void rebuild();
+    /** Add the rows of a repository the core just started tracking. Returns its index. */
+    QModelIndex insertRepository(RepositoryId repoId);
+    /** Remove a repository's rows, and its directory's if it was the last one there. */
+    void removeRepository(RepositoryId repoId);
+    /**
+     * Catch up with an edited repository: remote rows are added or dropped to
+     * match its remotes, and it moves if its directory changed. Returns its index.
+     */
+    QModelIndex updateRepository(RepositoryId repoId);
 
-    /** Emit dataChanged for the repository row(s) with the given name. */
-    void updateRepositoryStatus(const QString& repoName);
-    /** Emit dataChanged for the matching remote row(s). */
-    void updateRemoteCounts(const QString& repoName, const QString& remoteName);
+    /** Schedule a repaint of a repository's row after its data changed. */
+    void updateRepositoryStatus(RepositoryId repoId);
     /**
-     * Repaint every remote currently in the "Fetching..." state so its live
-     * elapsed counter advances. Returns the number of remotes still in flight.
+     * Schedule a repaint of one remote row of a repository, and track whether
+     * it is now in flight.
      */
-    int refreshActiveRemotes();
+    void updateRemoteCounts(RepositoryId repoId, const QString& remoteName);
+    /**
+     * Repaint the in-flight remotes for which isVisible holds so their live
+     * elapsed counters advance; the rest pick the time up whenever they are
+     * next painted. Costs O(in flight), not O(tree). Returns the number of
+     * remotes still in flight.
+     */
+    int refreshActiveRemotes(const std::function<bool(const QModelIndex&)>& isVisible);
 
     // Queries used by the view/controller
     bool isRepository(const QModelIndex& index) const;
     bool isDirectory(const QModelIndex& index) const;
-    /** Index into the repository list for a Repository/Remote node, else -1. */
-    int repositoryIndex(const QModelIndex& index) const;
+    /** Repository of a Repository/Remote node, else 0. */
+    RepositoryId repositoryId(const QModelIndex& index) const;
     /** Directory path for a Directory node, else empty. */
     QString directoryPath(const QModelIndex& index) const;
-    /** Model index for the repository identified by name+path, else invalid. */
-    QModelIndex indexForRepository(const QString& name, const QString& localPath) const;
+    /** Model index of a repository's row, else invalid. */
+    QModelIndex indexForRepository(RepositoryId repoId) const;
+
+private slots:
+    // Emits dataChanged for the rows marked dirty since the last flush.
+    void flushDirty();
 
 private:
     struct Node {
         NodeType type = NodeType::Directory;
         Node* parent = nullptr;
-        std::vector<std::unique_ptr<Node>> children;
+        std::vector<Node*> children;
         int row = 0;            // position within parent's children
         QString dirPath;        // Directory nodes
-        int repoIndex = -1;     // Repository / Remote nodes
+        RepositoryId repoId = 0; // Repository / Remote nodes
         int remoteIndex = -1;   // Remote nodes
+        bool remotesLoaded = false; // Repository nodes: remote children created
+        bool dirty = false;     // in m_dirty, awaiting a repaint
+        // Formatted data(), valid until the node is next marked dirty.
+        QString display;
+        QString toolTip;
+        bool displayCached = false;
+        bool toolTipCached = false;
     };
 
     Node* nodeFromIndex(const QModelIndex& index) const;
     QModelIndex indexForNode(Node* node) const;
     void buildTree();
+    // A blank node from the arena, reusing one released by forget() if any.
+    Node* allocNode();
+    // Appends a repository's node (without remotes) to dirNode, or one remote
+    // node to repoNode; the caller brackets them with beginInsertRows.
+    Node* appendRepositoryNode(Node* dirNode, const GitRepository& repo);
+    void appendRemoteNode(Node* repoNode, int remoteIndex);
+    // The directory's node, inserted in sorted position if it is new.
+    Node* directoryNode(const QString& dirPath);
+    void removeChildRows(Node* parent, int first, int last);
+    static void renumber(Node* parent, int from);
+    // Drops every reference to node and its descendants and returns them to
+    // the arena.
+    void forget(Node* node);
+    // Creates a repository's remote rows on first expansion.
+    void loadRemotes(Node* repoNode);
+    const GitRepository* repository(const Node* node) const;
+    const GitRemote* remote(const Node* node) const;
+    void markDirty(Node* node);
+    void trackActive(Node* remoteNode);
     QString displayText(const Node* node) const;
     QString toolTip(const Node* node) const;
 
-    const QList<GitRepository>* m_repositories;
-    std::unique_ptr<Node> m_root;
+    FetchCore* m_core;
+    std::deque<Node> m_arena;               // every node; addresses stay put as it grows
+    std::vector<Node*> m_freeNodes;         // released by removals, reused first
+    Node* m_root = nullptr;
+    QHash<QString, Node*> m_dirNodes;       // Directory nodes by path
+    QHash<RepositoryId, Node*> m_repoNodes; // Repository nodes of the current tree
+    std::vector<Node*> m_dirty;             // rows to repaint on the next flush
+    QSet<Node*> m_activeRemotes;            // Remote nodes in the Fetching state
+    QTimer* m_flushTimer;
 };
 
 #endif // REPOSITORYTREEMODEL_H
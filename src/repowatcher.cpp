@@ -1,73 +1,13 @@
 #include "repowatcher.h"
+#include "gitrefdb.h"
 
 #include <QDir>
 #include <QDirIterator>
-#include <QFile>
 #include <QFileInfo>
 #include <QTimer>
 
 namespace {
 constexpr int kDebounceMs = 400;
-
-// Resolve "gitdir: <path>" from a worktree's .git file (or return the directory
-// itself for a normal repository). Also resolves the shared common dir, where
-// refs/heads and refs/remotes live for worktrees.
-struct GitDirs {
-    QString gitDir;    // per-worktree git dir (holds HEAD)
-    QString commonDir; // shared dir (holds refs/heads, refs/remotes, packed-refs)
-    bool valid = false;
-};
-
-QString firstLine(const QString& filePath)
-{
-    QFile f(filePath);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return QString();
-    }
-    return QString::fromUtf8(f.readLine()).trimmed();
-}
-
-GitDirs resolveGitDirs(const QString& localPath)
-{
-    GitDirs dirs;
-    const QString dotGit = localPath + QStringLiteral("/.git");
-    QFileInfo fi(dotGit);
-
-    if (fi.isDir()) {
-        dirs.gitDir = dotGit;
-        dirs.commonDir = dotGit;
-        dirs.valid = true;
-        return dirs;
-    }
-
-    if (fi.isFile()) {
-        // Worktree: ".git" is a file containing "gitdir: <path>".
-        const QString line = firstLine(dotGit);
-        const QString marker = QStringLiteral("gitdir:");
-        if (line.startsWith(marker)) {
-            QString gd = line.mid(marker.size()).trimmed();
-            if (QDir::isRelativePath(gd)) {
-                gd = QDir(localPath).absoluteFilePath(gd);
-            }
-            dirs.gitDir = QDir(gd).absolutePath();
-
-            // The shared dir is named in <gitDir>/commondir, else it's gitDir.
-            const QString commonFile = dirs.gitDir + QStringLiteral("/commondir");
-            if (QFileInfo::exists(commonFile)) {
-                QString cd = firstLine(commonFile);
-                if (QDir::isRelativePath(cd)) {
-                    cd = QDir(dirs.gitDir).absoluteFilePath(cd);
-                }
-                dirs.commonDir = QDir(cd).absolutePath();
-            } else {
-                dirs.commonDir = dirs.gitDir;
-            }
-            dirs.valid = true;
-        }
-    }
-
-    return dirs;
-}
 } // namespace
 
 RepoWatcher::RepoWatcher(QObject *parent)
@@ -86,7 +26,8 @@ void RepoWatcher::setRepositories(const QList<GitRepository>& repos)
     QStringList paths;
     paths.reserve(repos.size());
     for (const GitRepository& repo : repos) {
-        paths.append(repo.localPath);
+        // The id too: a repository re-added at the same path is a new entry.
+        paths.append(QString::number(repo.id) + QLatin1Char(' ') + repo.localPath);
     }
     paths.sort();
     if (paths == m_lastPaths) {
@@ -113,7 +54,7 @@ void RepoWatcher::rebuild(const QList<GitRepository>& repos)
                 continue;
             }
             if (m_watcher.addPath(target)) {
-                m_pathToRepo.insert(target, repo.name);
+                m_pathToRepo.insert(target, repo.id);
             }
         }
     }
@@ -121,7 +62,7 @@ void RepoWatcher::rebuild(const QList<GitRepository>& repos)
 
 QStringList RepoWatcher::watchTargetsForRepo(const QString& localPath) const
 {
-    const GitDirs dirs = resolveGitDirs(localPath);
+    const GitRefDb::GitDirs dirs = GitRefDb::resolveGitDirs(localPath);
     if (!dirs.valid) {
         return {};
     }
@@ -182,9 +123,9 @@ void RepoWatcher::onPathChanged(const QString& path)
 
 void RepoWatcher::flushPending()
 {
-    const QSet<QString> pending = m_pending;
+    const QSet<RepositoryId> pending = m_pending;
     m_pending.clear();
-    for (const QString& repoName : pending) {
-        emit repositoryChanged(repoName);
+    for (RepositoryId repoId : pending) {
+        emit repositoryChanged(repoId);
     }
 }
@@ -15,7 +15,7 @@ class QTimer;
  * Watches the on-disk refs of each tracked repository (via inotify, through
  * QFileSystemWatcher) and reports when they change outside the app - e.g. a
  * local commit, checkout, reset, or rebase. Emits repositoryChanged with the
- * repository name so the controller can recompute that repo's commit counts.
+ * repository id so the controller can recompute that repo's commit counts.
  *
  * Events are debounced because a single git operation touches several ref files
  * in quick succession; watched directories survive git's atomic-rename ref
@@ -36,7 +36,7 @@ public:
     void setRepositories(const QList<GitRepository>& repos);
 
 signals:
-    void repositoryChanged(const QString& repoName);
+    void repositoryChanged(RepositoryId repoId);
 
 private slots:
     void onPathChanged(const QString& path);
@@ -49,9 +49,9 @@ private:
     QStringList watchTargetsForRepo(const QString& localPath) const;
 
     QFileSystemWatcher m_watcher;
-    QHash<QString, QString> m_pathToRepo; // watched path -> repository name
-    QStringList m_lastPaths;              // sorted localPaths of the last rebuild
-    QSet<QString> m_pending;              // repo names awaiting a debounced flush
+    QHash<QString, RepositoryId> m_pathToRepo; // watched path -> repository
+    QStringList m_lastPaths;                   // sorted "id path" keys of the last rebuild
+    QSet<RepositoryId> m_pending;              // repositories awaiting a debounced flush
     QTimer *m_debounce;
 };
 
@@ -0,0 +1,187 @@
+#include "runtimestate.h"
+#include "repositorystore.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <utility>
+
+namespace {
+constexpr int kFormatVersion = 1;
+
+// Stored statuses use these keys rather than fetchStatusText(), so rewording
+// the UI never invalidates a saved file. Only final outcomes are recorded.
+constexpr std::pair<FetchStatus, const char*> kStatusKeys[] = {
+    {FetchStatus::Ready, "ready"},
+    {FetchStatus::Success, "success"},
+    {FetchStatus::UpToDate, "upToDate"},
+    {FetchStatus::Error, "error"},
+    {FetchStatus::Timeout, "timeout"},
+    {FetchStatus::Cancelled, "cancelled"},
+};
+
+QString statusKey(FetchStatus status)
+{
+    for (const auto& [value, key] : kStatusKeys) {
+        if (value == status) {
+            return QString::fromLatin1(key);
+        }
+    }
+    return QStringLiteral("ready"); // Queued/Fetching never outlive the session
+}
+
+// Unknown keys read back as Ready.
+FetchStatus statusFromKey(const QString& key)
+{
+    for (const auto& [value, name] : kStatusKeys) {
+        if (key == QLatin1String(name)) {
+            return value;
+        }
+    }
+    return FetchStatus::Ready;
+}
+
+QString isoTime(qint64 ms)
+{
+    return ms > 0 ? QDateTime::fromMSecsSinceEpoch(ms).toString(Qt::ISODate) : QString();
+}
+} // namespace
+
+void RuntimeState::recordRepository(const QString& path, bool success, qint64 whenMs)
+{
+    Repository& repo = m_repositories[path];
+    repo.lastAttemptMs = whenMs;
+    repo.status = success ? FetchStatus::Success : FetchStatus::Error;
+    if (success) {
+        repo.lastSuccessMs = whenMs;
+    }
+    m_dirty = true;
+}
+
+void RuntimeState::recordRemote(const QString& path, const QString& remoteName, FetchStatus status, qint64 whenMs)
+{
+    Remote& remote = m_repositories[path].remotes[remoteName];
+    remote.status = status;
+    if (status == FetchStatus::Success || status == FetchStatus::UpToDate) {
+        remote.lastSuccessMs = whenMs;
+    }
+    m_dirty = true;
+}
+
+void RuntimeState::recordRemoteSha(const QString& path, const QString& remoteName, const QString& sha)
+{
+    Remote& remote = m_repositories[path].remotes[remoteName];
+    if (remote.sha != sha) {
+        remote.sha = sha;
+        m_dirty = true;
+    }
+}
+
+const RuntimeState::Repository* RuntimeState::find(const QString& path) const
+{
+    const auto it = m_repositories.constFind(path);
+    return it != m_repositories.constEnd() ? &it.value() : nullptr;
+}
+
+void RuntimeState::apply(QList<GitRepository>& repos) const
+{
+    for (GitRepository& repo : repos) {
+        const Repository* state = find(repo.localPath);
+        if (!state) {
+            continue;
+        }
+        repo.lastFetch = isoTime(state->lastSuccessMs);
+        repo.status = state->status;
+        for (GitRemote& remote : repo.remotes) {
+            const auto it = state->remotes.constFind(remote.name);
+            if (it != state->remotes.constEnd()) {
+                remote.lastFetch = isoTime(it->lastSuccessMs);
+                remote.status = it->status;
+            }
+        }
+    }
+}
+
+void RuntimeState::retain(const QList<GitRepository>& repos)
+{
+    QSet<QString> tracked;
+    tracked.reserve(repos.size());
+    for (const GitRepository& repo : repos) {
+        tracked.insert(repo.localPath);
+    }
+    for (auto it = m_repositories.begin(); it != m_repositories.end();) {
+        if (!tracked.contains(it.key())) {
+            it = m_repositories.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RuntimeState::load(const QString& path)
+{
+    m_repositories.clear();
+    m_dirty = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kFormatVersion) {
+        return;
+    }
+    const QJsonObject repositories = root.value("repositories").toObject();
+    for (auto it = repositories.constBegin(); it != repositories.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        Repository repo;
+        repo.lastSuccessMs = qint64(obj.value("lastSuccess").toDouble());
+        repo.lastAttemptMs = qint64(obj.value("lastAttempt").toDouble());
+        repo.status = statusFromKey(obj.value("status").toString());
+        const QJsonObject remotes = obj.value("remotes").toObject();
+        for (auto r = remotes.constBegin(); r != remotes.constEnd(); ++r) {
+            const QJsonObject remoteObj = r.value().toObject();
+            Remote remote;
+            remote.lastSuccessMs = qint64(remoteObj.value("lastSuccess").toDouble());
+            remote.status = statusFromKey(remoteObj.value("status").toString());
+            remote.sha = remoteObj.value("sha").toString();
+            repo.remotes.insert(r.key(), remote);
+        }
+        m_repositories.insert(it.key(), repo);
+    }
+}
+
+bool RuntimeState::save(const QString& path, QString* errorMessage)
+{
+    QJsonObject repositories;
+    for (auto it = m_repositories.constBegin(); it != m_repositories.constEnd(); ++it) {
+        QJsonObject remotes;
+        for (auto r = it->remotes.constBegin(); r != it->remotes.constEnd(); ++r) {
+            QJsonObject remote;
+            remote["lastSuccess"] = double(r->lastSuccessMs);
+            remote["status"] = statusKey(r->status);
+            if (!r->sha.isEmpty()) {
+                remote["sha"] = r->sha;
+            }
+            remotes.insert(r.key(), remote);
+        }
+        QJsonObject repo;
+        repo["lastSuccess"] = double(it->lastSuccessMs);
+        repo["lastAttempt"] = double(it->lastAttemptMs);
+        repo["status"] = statusKey(it->status);
+        repo["remotes"] = remotes;
+        repositories.insert(it.key(), repo);
+    }
+
+    QJsonObject root;
+    root["version"] = kFormatVersion;
+    root["repositories"] = repositories;
+    if (!RepositoryStore::writeFileAtomically(path, QJsonDocument(root).toJson(QJsonDocument::Compact), errorMessage)) {
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
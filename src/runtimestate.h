@@ -0,0 +1,62 @@
+#ifndef RUNTIMESTATE_H
+#define RUNTIMESTATE_H
+
+#include "gitmodels.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * Fetch history that outlives a session, kept apart from the configuration
+ * (repositories.json) because it changes on every fetch: per repository the
+ * last successful fetch, the last attempt and its outcome, and per remote the
+ * last successful fetch, its outcome and the remote-tracking tip it left.
+ * Keyed by repository path, the identity that survives a restart.
+ *
+ * On startup the core copies it back onto the repositories, so the fetch
+ * planner resumes every schedule where it left off instead of treating all
+ * repositories as overdue. Only touched on the main thread.
+ */
+class RuntimeState
+{
+public:
+    struct Remote {
+        qint64 lastSuccessMs = 0; // 0 = never
+        FetchStatus status = FetchStatus::Ready;
+        QString sha;              // remote-tracking tip after the last fetch
+    };
+    struct Repository {
+        qint64 lastSuccessMs = 0;
+        qint64 lastAttemptMs = 0;
+        FetchStatus status = FetchStatus::Ready;
+        QHash<QString, Remote> remotes;
+    };
+
+    /** A repository fetch finished (success or not) at whenMs. */
+    void recordRepository(const QString& path, bool success, qint64 whenMs);
+    /** A remote reached a final status at whenMs. */
+    void recordRemote(const QString& path, const QString& remoteName, FetchStatus status, qint64 whenMs);
+    /** The remote-tracking tip the last fetch or count calculation saw. */
+    void recordRemoteSha(const QString& path, const QString& remoteName, const QString& sha);
+
+    const Repository* find(const QString& path) const;
+    /** Restore lastFetch and status onto repositories recorded here. */
+    void apply(QList<GitRepository>& repos) const;
+    /** Forget repositories that are no longer tracked. */
+    void retain(const QList<GitRepository>& repos);
+
+    /** True if anything changed since the last load()/save(). */
+    bool isDirty() const { return m_dirty; }
+
+    /** Replace the contents with the file at path. Missing/corrupt files leave it empty. */
+    void load(const QString& path);
+    /** Atomically write the state to path. Returns false and sets *errorMessage on failure. */
+    bool save(const QString& path, QString* errorMessage = nullptr);
+
+private:
+    QHash<QString, Repository> m_repositories;
+    bool m_dirty = false;
+};
+
+#endif // RUNTIMESTATE_H
@@ -0,0 +1,198 @@
+#ifndef STATUSSNAPSHOT_H
+#define STATUSSNAPSHOT_H
+
+/**
+ * Binary status snapshot for shell prompts and other hot paths that can't
+ * afford even a socket round trip (see ControlServer for the full API).
+ *
+ * The application rewrites the file (temp file + rename) whenever repository
+ * state changes. A reader maps it and finds the repository containing a
+ * directory by binary search over path hashes, with no allocations and no Qt.
+ * This header is the whole reader; include it directly.
+ *
+ * Layout, native byte order (the file never leaves the machine):
+ *   Header, then Header::entryCount Entry records sorted by pathHash. Every
+ *   tracked repository has one entry for its path and one per worktree.
+ *
+ * Strings are NUL-terminated and truncated to fit. Counts are those of the
+ * repository's tracked branch.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STATUSSNAPSHOT_HAS_MMAP 1
+#endif
+
+namespace StatusSnapshot {
+
+constexpr char kMagic[4] = {'F', 'D', 'Z', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr int kMaxRemotes = 4; // further remotes count towards the totals only
+
+enum class Status : uint8_t {
+    Unknown = 0, // never fetched
+    Queued,
+    Fetching,
+    Success,
+    Error,
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entrySize;  // sizeof(Entry) of the writer
+    uint32_t entryCount;
+    int64_t writtenAt;   // epoch seconds
+};
+
+struct Remote {
+    char name[24];
+    int32_t ahead;
+    int32_t behind;
+    Status status;
+    uint8_t reserved[7];
+};
+
+struct Entry {
+    uint64_t pathHash;   // pathHash() of the repository or worktree path
+    int64_t lastFetch;   // epoch seconds of the last successful fetch, 0 if none
+    char branch[48];
+    int32_t ahead;       // summed over all remotes, like the window's repository row
+    int32_t behind;
+    Status status;
+    uint8_t remoteCount; // entries used in remotes[]
+    uint8_t reserved[6];
+    Remote remotes[kMaxRemotes];
+};
+
+static_assert(sizeof(Header) == 24, "snapshot header layout changed");
+static_assert(sizeof(Remote) == 40, "snapshot remote layout changed");
+static_assert(sizeof(Entry) == 240, "snapshot entry layout changed");
+
+/** FNV-1a over the path's bytes (UTF-8, no trailing slash). */
+inline uint64_t pathHash(const char *path, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(path[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/** Read-only view of a snapshot file. */
+class Reader
+{
+public:
+    Reader() = default;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    ~Reader() { close(); }
+
+    /** Map the file. False if it is missing, truncated or of another version. */
+    bool open(const char *filePath)
+    {
+        close();
+#ifdef STATUSSNAPSHOT_HAS_MMAP
+        const int fd = ::open(filePath, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+            return false;
+        }
+        void *data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the file alive, even once it is replaced
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        m_data = data;
+        m_size = static_cast<size_t>(st.st_size);
+
+        const Header *header = this->header();
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion
+            || header->entrySize != sizeof(Entry)
+            || m_size < sizeof(Header) + size_t(header->entryCount) * sizeof(Entry)) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        (void)filePath;
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#ifdef STATUSSNAPSHOT_HAS_MMAP
+        if (m_data) {
+            ::munmap(m_data, m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool isOpen() const { return m_data != nullptr; }
+    const Header* header() const { return static_cast<const Header*>(m_data); }
+    uint32_t size() const { return m_data ? header()->entryCount : 0; }
+    const Entry* entries() const
+    {
+        return reinterpret_cast<const Entry*>(static_cast<const char*>(m_data) + sizeof(Header));
+    }
+
+    /** The entry whose path hashes to hash, or nullptr. O(log n). */
+    const Entry* find(uint64_t hash) const
+    {
+        const Entry *first = entries();
+        uint32_t count = size();
+        while (count > 0) { // lower bound
+            const uint32_t step = count / 2;
+            if (first[step].pathHash < hash) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return (first != entries() + size() && first->pathHash == hash) ? first : nullptr;
+    }
+
+    /**
+     * The entry for the repository containing an absolute directory: the
+     * directory itself, else the nearest parent that is tracked.
+     */
+    const Entry* findContaining(const char *path, size_t length) const
+    {
+        while (length > 1 && path[length - 1] == '/') {
+            --length;
+        }
+        while (length > 0) {
+            if (const Entry *entry = find(pathHash(path, length))) {
+                return entry;
+            }
+            do {
+                --length;
+            } while (length > 0 && path[length] != '/');
+        }
+        return nullptr;
+    }
+
+private:
+    void *m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace StatusSnapshot
+
+#endif // STATUSSNAPSHOT_H
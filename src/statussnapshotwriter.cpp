@@ -0,0 +1,99 @@
+#include "statussnapshotwriter.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+namespace StatusSnapshot {
+
+namespace {
+
+Status snapshotStatus(FetchStatus status)
+{
+    switch (status) {
+    case FetchStatus::Queued:
+        return Status::Queued;
+    case FetchStatus::Fetching:
+        return Status::Fetching;
+    case FetchStatus::Success:
+    case FetchStatus::UpToDate:
+        return Status::Success;
+    case FetchStatus::Error:
+        return Status::Error;
+    default:
+        return Status::Unknown;
+    }
+}
+
+template <size_t N>
+void copyString(char (&dest)[N], const QString& source)
+{
+    const QByteArray utf8 = source.toUtf8();
+    const size_t length = std::min(size_t(utf8.size()), N - 1);
+    std::memcpy(dest, utf8.constData(), length);
+    dest[length] = '\0';
+}
+
+} // namespace
+
+QString defaultFilePath()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                        + QStringLiteral("/fetchdeeznutz");
+    QDir().mkpath(dir);
+    return dir + QStringLiteral("/status.bin");
+}
+
+QByteArray serialize(const QList<GitRepository>& repositories)
+{
+    std::vector<Entry> entries;
+    entries.reserve(repositories.size());
+    for (const GitRepository& repo : repositories) {
+        Entry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        const QDateTime lastFetch = QDateTime::fromString(repo.lastFetch, Qt::ISODate);
+        entry.lastFetch = lastFetch.isValid() ? lastFetch.toSecsSinceEpoch() : 0;
+        copyString(entry.branch, repo.branch);
+        entry.status = snapshotStatus(repo.status);
+        for (const GitRemote& remote : repo.remotes) {
+            entry.ahead += remote.commitsAhead;
+            entry.behind += remote.commitsBehind;
+            if (entry.remoteCount < kMaxRemotes) {
+                Remote& slot = entry.remotes[entry.remoteCount++];
+                copyString(slot.name, remote.name);
+                slot.ahead = remote.commitsAhead;
+                slot.behind = remote.commitsBehind;
+                slot.status = snapshotStatus(remote.status);
+            }
+        }
+
+        QStringList paths = repo.worktrees;
+        paths.prepend(repo.localPath);
+        for (const QString& path : paths) {
+            const QByteArray utf8 = QDir::cleanPath(path).toUtf8();
+            entry.pathHash = pathHash(utf8.constData(), size_t(utf8.size()));
+            entries.push_back(entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.pathHash < b.pathHash;
+    });
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entrySize = sizeof(Entry);
+    header.entryCount = uint32_t(entries.size());
+    header.writtenAt = QDateTime::currentSecsSinceEpoch();
+
+    QByteArray data;
+    data.reserve(int(sizeof(Header) + entries.size() * sizeof(Entry)));
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(entries.data()), qsizetype(entries.size() * sizeof(Entry)));
+    return data;
+}
+
+} // namespace StatusSnapshot
@@ -0,0 +1,27 @@
+#ifndef STATUSSNAPSHOTWRITER_H
+#define STATUSSNAPSHOTWRITER_H
+
+#include "gitmodels.h"
+#include "statussnapshot.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * Builds the status snapshot (statussnapshot.h) from the repository list.
+ * Writing it is left to the caller (RepositoryStore::writeFileAtomically).
+ */
+namespace StatusSnapshot {
+
+/**
+ * $XDG_CACHE_HOME/fetchdeeznutz/status.bin (~/.cache/... by default), where
+ * readers look for it. The directory is created if needed.
+ */
+QString defaultFilePath();
+
+QByteArray serialize(const QList<GitRepository>& repositories);
+
+} // namespace StatusSnapshot
+
+#endif // STATUSSNAPSHOTWRITER_H